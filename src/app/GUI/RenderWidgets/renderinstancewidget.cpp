@@ -45,6 +45,8 @@ RenderInstanceWidget::RenderInstanceWidget(
     iniGUI();
     connect(&mSettings, &RenderInstanceSettings::stateChanged,
             this, &RenderInstanceWidget::updateFromSettings);
+    connect(&mSettings, &RenderInstanceSettings::renderFrameChanged,
+            this, &RenderInstanceWidget::updateNameLabel);
     updateFromSettings();
 }
 
@@ -54,27 +56,14 @@ RenderInstanceWidget::RenderInstanceWidget(const RenderInstanceSettings& sett,
     iniGUI();
     connect(&mSettings, &RenderInstanceSettings::stateChanged,
             this, &RenderInstanceWidget::updateFromSettings);
+    connect(&mSettings, &RenderInstanceSettings::renderFrameChanged,
+            this, &RenderInstanceWidget::updateNameLabel);
     updateFromSettings();
 }
 
 void RenderInstanceWidget::iniGUI()
 {
-    if (!OutputSettingsProfile::sOutputProfilesLoaded) {
-        OutputSettingsProfile::sOutputProfilesLoaded = true;
-        QDir dirPath(AppSupport::getAppOutputProfilesPath());
-        dirPath.setSorting(QDir::SortFlag::Name);
-        for (const auto &fileInfo : dirPath.entryInfoList()) {
-            if (!fileInfo.isFile()) { continue; }
-            if (!fileInfo.completeSuffix().contains("conf")) { continue; }
-            const auto profile = enve::make_shared<OutputSettingsProfile>();
-            try {
-                profile->load(fileInfo.absoluteFilePath());
-            } catch(const std::exception& e) {
-                gPrintExceptionCritical(e);
-            }
-            OutputSettingsProfile::sOutputProfiles << profile;
-        }
-    }
+    OutputSettingsProfile::sLoadOutputProfiles();
 
     setCheckable(true);
     setObjectName("darkWidget");
@@ -213,34 +202,11 @@ void RenderInstanceWidget::updateFromSettings() {
     bool enabled = renderState != RenderState::paused &&
        renderState != RenderState::rendering;
     setEnabled(enabled);
+    if(renderState == RenderState::finished) mCheckBox->setChecked(false);
 
-    QString nameLabelTxt = QString(mSettings.getName());
-    const OutputSettings &outputSettings = mSettings.getOutputRenderSettings();
-
-    const auto format = outputSettings.fOutputFormat;
-    if (format) {
-        QString formatString(format->name);
-        if (formatString == "image2") {
-            const auto codec = outputSettings.fVideoCodec;
-            if (codec) { formatString = QString(codec->name); }
-        }
-        nameLabelTxt.append(QString(" [%1]").arg(QString(formatString).toUpper()));
-    }
-
-    if(renderState == RenderState::error) {
-        nameLabelTxt += tr(" : Error"); //mSettings.getRenderError();
-    } else if(renderState == RenderState::finished) {
-        nameLabelTxt += tr(" : Finished");
-        mCheckBox->setChecked(false);
-    } else if(renderState == RenderState::rendering) {
-        nameLabelTxt += tr(" : Rendering ...");
-    } else if(renderState == RenderState::waiting) {
-        nameLabelTxt += tr(" : Waiting ...");
-    } else if(renderState == RenderState::paused) {
-        nameLabelTxt += tr(" : Paused");
-    }
-    mNameLabel->setText(nameLabelTxt);
+    updateNameLabel();
 
+    const OutputSettings &outputSettings = mSettings.getOutputRenderSettings();
     QString destinationTxt = mSettings.getOutputDestination();
     mOutputDestinationLineEdit->setText(destinationTxt);
 
@@ -265,6 +231,43 @@ void RenderInstanceWidget::updateFromSettings() {
                                                     renderSettings);
 }
 
+void RenderInstanceWidget::updateNameLabel() {
+    QString nameLabelTxt = QString(mSettings.getName());
+    const auto renderState = mSettings.getCurrentState();
+    const OutputSettings &outputSettings = mSettings.getOutputRenderSettings();
+
+    const auto format = outputSettings.fOutputFormat;
+    if (format) {
+        QString formatString(format->name);
+        if (formatString == "image2") {
+            const auto codec = outputSettings.fVideoCodec;
+            if (codec) { formatString = QString(codec->name); }
+        }
+        nameLabelTxt.append(QString(" [%1]").arg(QString(formatString).toUpper()));
+    }
+
+    if(renderState == RenderState::error) {
+        nameLabelTxt += tr(" : Error"); //mSettings.getRenderError();
+    } else if(renderState == RenderState::finished) {
+        nameLabelTxt += tr(" : Finished in %1s (%2 fps)").arg(
+                            QString::number(mSettings.renderElapsed()/1000., 'f', 1),
+                            QString::number(mSettings.renderFps(), 'f', 1));
+    } else if(renderState == RenderState::rendering) {
+        const int eta = mSettings.renderEta();
+        if(eta < 0) nameLabelTxt += tr(" : Rendering ...");
+        else nameLabelTxt += tr(" : Rendering %1 fps, ETA %2s").arg(
+                                 QString::number(mSettings.renderFps(), 'f', 1),
+                                 QString::number(eta));
+    } else if(renderState == RenderState::waiting) {
+        nameLabelTxt += tr(" : Waiting ...");
+    } else if(renderState == RenderState::paused) {
+        nameLabelTxt += tr(" : Paused");
+    }
+    mNameLabel->setText(nameLabelTxt);
+    mNameLabel->setToolTip(renderState == RenderState::finished ?
+                               statsToolTip() : QString());
+}
+
 RenderInstanceSettings &RenderInstanceWidget::getSettings() {
     return mSettings;
 }
@@ -533,3 +536,18 @@ void OutputProfilesListButton::mousePressEvent(QMouseEvent *e) {
         }
     }
 }
+
+QString RenderInstanceWidget::statsToolTip() const {
+    const auto stats = mSettings.renderStats();
+    QStringList lines;
+    lines << tr("Frames: %1").arg(stats.value("frames").toInt());
+    lines << tr("Time: %1s").arg(QString::number(stats.value("elapsedMs").toDouble()/1000., 'f', 1));
+    lines << tr("Frames per second: %1").arg(QString::number(stats.value("fps").toDouble(), 'f', 2));
+    lines << tr("Peak memory: %1 MB").arg(stats.value("peakMemoryMB").toInt());
+    const auto stages = stats.value("stageMs").toObject();
+    for (auto it = stages.begin(); it != stages.end(); ++it) {
+        lines << tr("%1: %2s").arg(it.key(),
+                                   QString::number(it.value().toDouble()/1000., 'f', 2));
+    }
+    return lines.join("\n");
+}
@@ -89,6 +89,9 @@ protected:
     void updateOutputDestinationFromCurrentFormat();
 private:
     void updateFromSettings();
+    //! @brief Name, state and progress only, updated on every rendered frame
+    void updateNameLabel();
+    QString statsToolTip() const;
 
     void outputSettingsProfileSelected(OutputSettingsProfile *profile);
 
@@ -172,8 +172,9 @@ RenderWidget::RenderWidget(QWidget *parent)
 
     connect(vidEmitter, &VideoEncoderEmitter::encodingStartFailed,
             this, &RenderWidget::handleRenderFailed);
+    // queued, outputs of the failed render are put back first
     connect(vidEmitter, &VideoEncoderEmitter::encodingStartFailed,
-            this, &RenderWidget::sendNextForRender);
+            this, &RenderWidget::sendNextForRender, Qt::QueuedConnection);
 }
 
 void RenderWidget::createNewRenderInstanceWidgetForCanvas(Canvas *canvas)
@@ -303,7 +304,8 @@ void RenderWidget::updateRenderSettings()
     }
 }
 
-void RenderWidget::render(RenderInstanceSettings &settings)
+QList<RenderInstanceSettings*> RenderWidget::render(RenderInstanceSettings &settings,
+                                                   const QList<RenderInstanceSettings*> &outputs)
 {
     const RenderSettings &renderSettings = settings.getRenderSettings();
     mRenderProgressBar->setRange(renderSettings.fMinFrame,
@@ -322,11 +324,12 @@ void RenderWidget::render(RenderInstanceSettings &settings)
         }
     }
 
-    RenderHandler::sInstance->renderFromSettings(&settings);
+    const auto rejected = RenderHandler::sInstance->renderFromSettings(&settings, outputs);
     connect(&settings, &RenderInstanceSettings::renderFrameChanged,
             this, &RenderWidget::setRenderedFrame);
     connect(&settings, &RenderInstanceSettings::stateChanged,
             this, &RenderWidget::handleRenderState);
+    return rejected;
 }
 
 void RenderWidget::render()
@@ -366,10 +369,34 @@ void RenderWidget::sendNextForRender()
 {
     if (mAwaitingSettings.isEmpty()) { return; }
     const auto wid = mAwaitingSettings.takeFirst();
+    // one render at a time, parallel jobs are only available
+    // in the command line renderer (--renderer --jobs)
     if (wid->isChecked() && wid->getSettings().getTargetCanvas()) {
         //disableButtons();
         wid->setDisabled(true);
-        render(wid->getSettings());
+        // outputs of the same scene and frames are encoded from one render
+        QList<RenderInstanceWidget*> sharing;
+        QList<RenderInstanceSettings*> outputs;
+        for (int i = 0; i < mAwaitingSettings.count();) {
+            const auto other = mAwaitingSettings.at(i);
+            if (other->isChecked() &&
+                VideoEncoder::sCanShareRender(wid->getSettings(),
+                                              other->getSettings())) {
+                other->setDisabled(true);
+                sharing << other;
+                outputs << &other->getSettings();
+                mAwaitingSettings.removeAt(i);
+            } else { i++; }
+        }
+        const auto rejected = render(wid->getSettings(), outputs);
+        // outputs that did not join the render wait for their own turn
+        for (int i = sharing.count() - 1; i >= 0; i--) {
+            const auto other = sharing.at(i);
+            if (!rejected.contains(&other->getSettings())) { continue; }
+            other->setDisabled(false);
+            other->getSettings().setCurrentState(RenderState::waiting);
+            mAwaitingSettings.prepend(other);
+        }
     } else { sendNextForRender(); }
 }
 
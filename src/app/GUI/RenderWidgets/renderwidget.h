@@ -59,7 +59,8 @@ signals:
                             const RenderState &state);
 
 private:
-    void render(RenderInstanceSettings& settings);
+    QList<RenderInstanceSettings*> render(RenderInstanceSettings& settings,
+                                          const QList<RenderInstanceSettings*> &outputs);
     void addRenderInstanceWidget(RenderInstanceWidget *wid);
     QVBoxLayout *mMainLayout;
     QProgressBar *mRenderProgressBar;
@@ -379,10 +379,28 @@ void CanvasWindow::writeState(eWriteStream &dst) const
     dst << mViewTransform;
 }
 
+struct CanvasWindowState
+{
+    int fSceneReadId;
+    int fSceneDocumentId;
+    QMatrix fViewTransform;
+};
+
+// shared by readState and sSkipState, reads what writeState wrote
+static CanvasWindowState readCanvasWindowState(eReadStream &src)
+{
+    CanvasWindowState state;
+    src >> state.fSceneReadId;
+    src >> state.fSceneDocumentId;
+    src >> state.fViewTransform;
+    return state;
+}
+
 void CanvasWindow::readState(eReadStream &src)
 {
-    int sceneReadId; src >> sceneReadId;
-    int sceneDocumentId; src >> sceneDocumentId;
+    const auto state = readCanvasWindowState(src);
+    const int sceneReadId = state.fSceneReadId;
+    const int sceneDocumentId = state.fSceneDocumentId;
 
     src.addReadStreamDoneTask([this, sceneReadId, sceneDocumentId]
                               (eReadStream& src) {
@@ -397,10 +415,15 @@ void CanvasWindow::readState(eReadStream &src)
         setCurrentCanvas(enve_cast<Canvas*>(sceneBox));
     });
 
-    src >> mViewTransform;
+    mViewTransform = state.fViewTransform;
     mFitToSizeBlocked = true;
 }
 
+void CanvasWindow::sSkipState(eReadStream &src)
+{
+    readCanvasWindowState(src);
+}
+
 void CanvasWindow::readStateXEV(XevReadBoxesHandler& boxReadHandler,
                                 const QDomElement& ele)
 {
@@ -26,6 +26,8 @@
 #include "layouthandler.h"
 #include "Private/document.h"
 #include "widgets/editablecombobox.h"
+#include "canvaswindow.h"
+#include "timelinewidget.h"
 
 #include <QPushButton>
 
@@ -88,3 +90,17 @@ void LayoutHandler::clear() {
     for(int i = 0; i < mComboBox->count(); i++)
         removeAt(0);
 }
+
+void LayoutData::sSkip(eReadStream& src) {
+    QString name; src >> name;
+    WrapperNode::sSkip(src, CanvasWindow::sSkipState);
+    WrapperNode::sSkip(src, TimelineWidget::sSkipState);
+}
+
+void LayoutHandler::sSkip(eReadStream& src) {
+    int nLays; src >> nLays;
+    for(int i = 0; i < nLays; i++) LayoutData::sSkip(src);
+    int nScenes; src >> nScenes;
+    for(int i = 0; i < nScenes; i++) LayoutData::sSkip(src);
+    int relCurrentId; src >> relCurrentId;
+}
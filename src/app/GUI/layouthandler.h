@@ -58,6 +58,9 @@ struct LayoutData {
         fTimelineLayout->writeData(dst);
     }
 
+    //! @brief Skips the data written by write()
+    static void sSkip(eReadStream& src);
+
     void read(eReadStream& src) {
         src >> fName;
         fSceneLayout->readData(src);
@@ -122,6 +125,10 @@ public:
         dst << mCurrentId;
     }
 
+    //! @brief Skips the data written by write(), for readers that
+    //! have no window layout (e.g. the command line renderer)
+    static void sSkip(eReadStream& src);
+
     void read(eReadStream& src) {
         setCurrent(-1);
 
@@ -664,6 +664,21 @@ void MainWindow::setupMenuBar()
             });
     cmdAddAction(previewCacheAct);
 
+    const auto videoProxiesAct = mViewMenu->addAction(tr("Video Proxies"));
+    videoProxiesAct->setCheckable(true);
+    videoProxiesAct->setChecked(eSettings::instance().fVideoProxies);
+    connect(videoProxiesAct, &QAction::triggered,
+            this, [this, videoProxiesAct]() {
+                const bool checked = videoProxiesAct->isChecked();
+                eSettings::sInstance->fVideoProxies = checked;
+                eSettings::sInstance->saveKeyToFile("VideoProxies");
+                statusBar()->showMessage(tr("%1 Video Proxies").arg(checked ?
+                                                                        tr("Enabled") :
+                                                                        tr("Disabled")),
+                                         5000);
+            });
+    cmdAddAction(videoProxiesAct);
+
     mViewMenu->addSeparator();
 
     mRasterEffectsVisible = mViewMenu->addAction(
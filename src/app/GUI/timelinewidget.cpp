@@ -390,32 +390,55 @@ void TimelineWidget::writeState(eWriteStream &dst) const {
     dst.write(&rules.fTarget, sizeof(SWT_Target));
 }
 
+struct TimelineState {
+    int fSceneReadId;
+    int fSceneDocumentId;
+    QString fSearch;
+    int fSliderPos;
+    int fFrame;
+    int fMinViewedFrame;
+    int fMaxViewedFrame;
+    bool fHasRules = false;
+    SWT_BoxRule fBoxRule;
+    SWT_Type fType;
+    SWT_Target fTarget;
+};
+
+// shared by readState and sSkipState, reads what writeState wrote
+static TimelineState readTimelineState(eReadStream &src) {
+    TimelineState state;
+    src >> state.fSceneReadId;
+    src >> state.fSceneDocumentId;
+
+    src >> state.fSearch;
+    src >> state.fSliderPos;
+
+    src >> state.fFrame;
+    src >> state.fMinViewedFrame;
+    src >> state.fMaxViewedFrame;
+
+    if(src.evFileVersion() > 6) {
+        src.read(&state.fBoxRule, sizeof(SWT_BoxRule));
+        src.read(&state.fType, sizeof(SWT_Type));
+        src.read(&state.fTarget, sizeof(SWT_Target));
+        state.fHasRules = true;
+    }
+    return state;
+}
+
 void TimelineWidget::readState(eReadStream &src) {
     const int id = mBoxesListWidget->getId();
     src.objListIdConv().assign(id);
 
-    int sceneReadId; src >> sceneReadId;
-    int sceneDocumentId; src >> sceneDocumentId;
-
-    QString search; src >> search;
-    int sliderPos; src >> sliderPos;
-
-    int frame; src >> frame;
-    int minViewedFrame; src >> minViewedFrame;
-    int maxViewedFrame; src >> maxViewedFrame;
-
-    if(src.evFileVersion() > 6) {
-        SWT_BoxRule boxRule;
-        SWT_Type type;
-        SWT_Target target;
-        src.read(&boxRule, sizeof(SWT_BoxRule));
-        src.read(&type, sizeof(SWT_Type));
-        src.read(&target, sizeof(SWT_Target));
-        setBoxRule(boxRule);
-        setType(type);
-        setTarget(target);
+    const auto state = readTimelineState(src);
+    if(state.fHasRules) {
+        setBoxRule(state.fBoxRule);
+        setType(state.fType);
+        setTarget(state.fTarget);
     }
 
+    const int sceneReadId = state.fSceneReadId;
+    const int sceneDocumentId = state.fSceneDocumentId;
     src.addReadStreamDoneTask([this, sceneReadId, sceneDocumentId]
                               (eReadStream& src) {
         BoundingBox* sceneBox = nullptr;
@@ -427,13 +450,17 @@ void TimelineWidget::readState(eReadStream &src) {
         setCurrentScene(enve_cast<Canvas*>(sceneBox));
     });
 
-    mSearchLine->setText(search);
+    mSearchLine->setText(state.fSearch);
 
-    //mBoxesListScrollArea->verticalScrollBar()->setSliderPosition(sliderPos);
-    //mKeysView->setViewedVerticalRange(sliderPos, sliderPos + mBoxesListScrollArea->height());
+    //mBoxesListScrollArea->verticalScrollBar()->setSliderPosition(state.fSliderPos);
+    //mKeysView->setViewedVerticalRange(state.fSliderPos, state.fSliderPos + mBoxesListScrollArea->height());
 
-    mFrameScrollBar->setFirstViewedFrame(frame);
-    setViewedFrameRange({minViewedFrame, maxViewedFrame});
+    mFrameScrollBar->setFirstViewedFrame(state.fFrame);
+    setViewedFrameRange({state.fMinViewedFrame, state.fMaxViewedFrame});
+}
+
+void TimelineWidget::sSkipState(eReadStream &src) {
+    readTimelineState(src);
 }
 
 void TimelineWidget::readStateXEV(XevReadBoxesHandler& boxReadHandler,
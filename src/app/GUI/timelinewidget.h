@@ -77,6 +77,8 @@ public:
 
     void writeState(eWriteStream& dst) const;
     void readState(eReadStream& src);
+    //! @brief Skips the data written by writeState()
+    static void sSkipState(eReadStream& src);
 
     void readStateXEV(XevReadBoxesHandler& boxReadHandler,
                       const QDomElement& ele,
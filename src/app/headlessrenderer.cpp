@@ -0,0 +1,704 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "headlessrenderer.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QDir>
+#include <QProcess>
+#include <QTimer>
+#include <iostream>
+
+#include "renderhandler.h"
+#include "videoencoder.h"
+#include "eimporters.h"
+#include "canvas.h"
+#include "outputsettings.h"
+#include "renderinstancesettings.h"
+#include "Private/document.h"
+#include "ReadWrite/evformat.h"
+#include "ReadWrite/filefooter.h"
+#include "ReadWrite/ereadstream.h"
+#include "Private/esettings.h"
+#include "segmentmuxer.h"
+#include "GUI/layouthandler.h"
+
+using namespace Friction::Core;
+
+static void setFormatOption(OutputSettings &settings,
+                            const QString &key,
+                            const QString &value)
+{
+    auto &options = settings.fVideoOptions.fValues;
+    for (int i = options.count() - 1; i >= 0; i--) {
+        if (options.at(i).fType == FormatType::fTypeFormat &&
+            options.at(i).fKey == key) { options.removeAt(i); }
+    }
+    options << FormatOption{key, value, FormatType::fTypeFormat};
+}
+
+static int formatOption(const OutputSettings &settings,
+                        const QString &key,
+                        const int def)
+{
+    for (const auto &option : settings.fVideoOptions.fValues) {
+        if (option.fType == FormatType::fTypeFormat && option.fKey == key) {
+            return option.fValue.toInt();
+        }
+    }
+    return def;
+}
+
+HeadlessRenderer::HeadlessRenderer(Document &document,
+                                   RenderHandler &renderHandler) :
+    mDocument(document),
+    mRenderHandler(renderHandler)
+{
+    //ImportHandler::sInstance->addImporter<eXevImporter>();
+    ImportHandler::sInstance->addImporter<evImporter>();
+    ImportHandler::sInstance->addImporter<eSvgImporter>();
+}
+
+bool HeadlessRenderer::start(const QStringList &args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Render a Friction project without user interface."));
+    parser.addHelpOption();
+    parser.addPositionalArgument("project", tr("Project file (.friction) to render."));
+
+    const QCommandLineOption rendererOpt("renderer",
+                                         tr("Run the command line renderer."));
+    const QCommandLineOption softwareGLOpt("software-gl",
+                                           tr("Use software (CPU) OpenGL."));
+    const QCommandLineOption listOpt("list",
+                                     tr("List scenes, render queue and output profiles, then exit."));
+    const QCommandLineOption queueOpt("queue",
+                                      tr("Render queue item saved in the project (1 = first)."),
+                                      "index");
+    const QCommandLineOption sceneOpt("scene",
+                                      tr("Scene to render, by name or index (1 = first)."),
+                                      "scene");
+    const QCommandLineOption profileOpt("profile",
+                                        tr("Output profile, by name or path to a profile file."),
+                                        "profile");
+    const QCommandLineOption outputOpt({"o", "output"},
+                                       tr("Output file."),
+                                       "file");
+    const QCommandLineOption startOpt("start",
+                                      tr("First frame to render."),
+                                      "frame");
+    const QCommandLineOption endOpt("end",
+                                    tr("Last frame to render."),
+                                    "frame");
+    const QCommandLineOption resolutionOpt("resolution",
+                                           tr("Resolution in percent of the scene size."),
+                                           "percent");
+    const QCommandLineOption chunksOpt("chunks",
+                                       tr("Split the frame range into chunks rendered by parallel processes."),
+                                       "count");
+    const QCommandLineOption threadsOpt("threads",
+                                        tr("Maximum number of CPU threads to use."),
+                                        "count");
+    const QCommandLineOption memoryOpt("memory",
+                                       tr("Maximum memory usage in MB."),
+                                       "MB");
+    const QCommandLineOption jobsOpt("jobs",
+                                     tr("Render all checked render queue items, count at a time in parallel processes (command line renderer only, the render queue of the GUI renders one item at a time)."),
+                                     "count");
+    const QCommandLineOption pipeOpt("pipe",
+                                     tr("Stream uncompressed frames as y4m or raw in a pixel format (rgba, yuv420p, ...) to stdout, or to --output."),
+                                     "format");
+    QCommandLineOption startNumberOpt("start-number",
+                                      tr("Number of the first image of an image sequence."),
+                                      "number");
+    startNumberOpt.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOptions({rendererOpt, softwareGLOpt, listOpt, queueOpt,
+                       sceneOpt, profileOpt, outputOpt, startOpt,
+                       endOpt, resolutionOpt, chunksOpt, threadsOpt,
+                       memoryOpt, jobsOpt, pipeOpt, startNumberOpt});
+
+    if (!parser.parse(args)) {
+        finish(exitInvalidArgs, parser.errorText());
+        return false;
+    }
+    if (parser.isSet("help")) { parser.showHelp(exitSuccess); }
+
+    const auto positional = parser.positionalArguments();
+    if (positional.count() != 1) {
+        finish(exitInvalidArgs, tr("Expected exactly one project file, see --help."));
+        return false;
+    }
+
+    // caps are read at runtime, the thread pool is already created
+    if (parser.isSet(threadsOpt)) {
+        eSettings::sInstance->fCpuThreadsCap = qMax(1, parser.value(threadsOpt).toInt());
+    }
+    if (parser.isSet(memoryOpt)) {
+        eSettings::sInstance->fRamMBCap = intMB(qMax(0, parser.value(memoryOpt).toInt()));
+    }
+
+    OutputSettingsProfile::sLoadOutputProfiles();
+
+    const QString projectPath = QFileInfo(positional.first()).absoluteFilePath();
+    try {
+        loadProject(projectPath);
+    } catch(const std::exception& e) {
+        finish(exitLoadFailed, gAllTextFromException(e));
+        return false;
+    }
+
+    if (parser.isSet(listOpt)) {
+        printInfo();
+        finish(exitSuccess);
+        return false;
+    }
+
+    if (parser.isSet(jobsOpt)) {
+        for (const auto &opt : {queueOpt, sceneOpt, profileOpt, outputOpt,
+                                startOpt, endOpt, chunksOpt, pipeOpt}) {
+            if (!parser.isSet(opt)) { continue; }
+            finish(exitInvalidArgs, tr("--jobs renders the render queue as saved, "
+                                       "it can not be combined with --%1.").arg(opt.names().last()));
+            return false;
+        }
+        // every job is a render queue item rendered by its own worker
+        QStringList workerArgs{"--renderer", projectPath};
+        if (parser.isSet(softwareGLOpt)) { workerArgs << "--software-gl"; }
+        if (parser.isSet(resolutionOpt)) {
+            workerArgs << "--resolution" << parser.value(resolutionOpt);
+        }
+        return startJobs(qMax(1, parser.value(jobsOpt).toInt()), workerArgs);
+    }
+
+    // use the saved render queue unless told otherwise
+    if (parser.isSet(queueOpt)) {
+        bool ok = false;
+        const int id = parser.value(queueOpt).toInt(&ok) - 1;
+        if (!ok || id < 0 || id >= mQueue.count()) {
+            finish(exitInvalidArgs, tr("Invalid render queue item %1.").arg(parser.value(queueOpt)));
+            return false;
+        }
+        mSettings = mQueue.at(id);
+    } else if (!parser.isSet(sceneOpt) && !parser.isSet(profileOpt)) {
+        for (int i = 0; i < mQueue.count(); i++) {
+            if (mQueueChecked.at(i)) {
+                mSettings = mQueue.at(i);
+                break;
+            }
+        }
+    }
+
+    if (!mSettings) {
+        const auto scene = parser.isSet(sceneOpt) ?
+                               findScene(parser.value(sceneOpt)) :
+                               (mDocument.fScenes.isEmpty() ? nullptr :
+                                                              mDocument.fScenes.first().get());
+        if (!scene) {
+            finish(exitInvalidArgs, tr("Scene not found."));
+            return false;
+        }
+        mSettings = new RenderInstanceSettings(scene);
+        mSettings->setParent(this);
+    } else if (parser.isSet(sceneOpt)) {
+        const auto scene = findScene(parser.value(sceneOpt));
+        if (!scene) {
+            finish(exitInvalidArgs, tr("Scene not found."));
+            return false;
+        }
+        mSettings->setTargetCanvas(scene);
+    }
+
+    const auto scene = mSettings->getTargetCanvas();
+    if (!scene) {
+        finish(exitInvalidArgs, tr("Render queue item has no scene."));
+        return false;
+    }
+
+    const bool toStdout = parser.isSet(pipeOpt) &&
+                          (!parser.isSet(outputOpt) || parser.value(outputOpt) == "-");
+    if (parser.isSet(pipeOpt)) {
+        const auto pipeSettings = OutputSettings::sPipeSettings(parser.value(pipeOpt));
+        if (!pipeSettings.fOutputFormat) {
+            finish(exitInvalidArgs, tr("Unknown pipe format %1.").arg(parser.value(pipeOpt)));
+            return false;
+        }
+        mSettings->setOutputSettingsProfile(nullptr);
+        mSettings->setOutputRenderSettings(pipeSettings);
+        if (toStdout) {
+            mSettings->setOutputDestination("pipe:1");
+            mLog = &std::cerr;
+        }
+    } else if (parser.isSet(profileOpt)) {
+        const auto profile = findProfile(parser.value(profileOpt));
+        if (!profile) {
+            finish(exitInvalidArgs, tr("Output profile %1 not found.").arg(parser.value(profileOpt)));
+            return false;
+        }
+        mSettings->setOutputSettingsProfile(profile);
+    } else if (!mSettings->getOutputSettingsProfile() &&
+               !mSettings->getOutputRenderSettings().fVideoEnabled &&
+               !mSettings->getOutputRenderSettings().fAudioEnabled) {
+        finish(exitInvalidArgs, tr("No output profile, use --profile."));
+        return false;
+    }
+
+    if (parser.isSet(outputOpt) && !toStdout) {
+        mSettings->setOutputDestination(QFileInfo(parser.value(outputOpt)).absoluteFilePath());
+    }
+    if (mSettings->getOutputDestination().isEmpty()) {
+        finish(exitInvalidArgs, tr("No output file, use --output."));
+        return false;
+    }
+
+    auto renderSettings = mSettings->getRenderSettings();
+    bool validArgs = true;
+    if (parser.isSet(startOpt)) {
+        renderSettings.fMinFrame = parser.value(startOpt).toInt(&validArgs);
+    }
+    if (validArgs && parser.isSet(endOpt)) {
+        renderSettings.fMaxFrame = parser.value(endOpt).toInt(&validArgs);
+    }
+    if (validArgs && parser.isSet(resolutionOpt)) {
+        const qreal percent = parser.value(resolutionOpt).toDouble(&validArgs);
+        validArgs = validArgs && percent > 0;
+        renderSettings.fResolution = percent/100;
+        renderSettings.fVideoWidth = qRound(renderSettings.fBaseWidth*
+                                            renderSettings.fResolution);
+        renderSettings.fVideoHeight = qRound(renderSettings.fBaseHeight*
+                                             renderSettings.fResolution);
+    }
+    if (!validArgs || renderSettings.fMinFrame > renderSettings.fMaxFrame) {
+        finish(exitInvalidArgs, tr("Invalid frame range or resolution."));
+        return false;
+    }
+    mSettings->setRenderSettings(renderSettings);
+
+    if (parser.isSet(startNumberOpt)) {
+        auto outputSettings = mSettings->getOutputRenderSettings();
+        setFormatOption(outputSettings, "start_number",
+                        parser.value(startNumberOpt));
+        mSettings->setOutputRenderSettings(outputSettings);
+    }
+
+    const int chunks = qMin(parser.value(chunksOpt).toInt(),
+                            renderSettings.fMaxFrame - renderSettings.fMinFrame + 1);
+    if (chunks > 1 && parser.isSet(pipeOpt)) {
+        finish(exitInvalidArgs, tr("Chunked rendering can not write to a pipe."));
+        return false;
+    }
+    if (chunks > 1) {
+        // workers get the same job, but their own frame range and output
+        QStringList workerArgs{"--renderer", projectPath};
+        for (const auto &opt : {queueOpt, sceneOpt, profileOpt, resolutionOpt}) {
+            if (!parser.isSet(opt)) { continue; }
+            workerArgs << "--" + opt.names().first() << parser.value(opt);
+        }
+        if (parser.isSet(softwareGLOpt)) { workerArgs << "--software-gl"; }
+        if (!parser.isSet(queueOpt) && mQueue.contains(mSettings)) {
+            workerArgs << "--queue" << QString::number(mQueue.indexOf(mSettings) + 1);
+        }
+        return startChunks(chunks, workerArgs);
+    }
+
+    // the scene has no window, tasks are only qued for visible scenes
+    mDocument.setActiveScene(scene);
+    mDocument.addVisibleScene(scene);
+
+    const auto vidEmitter = VideoEncoder::sInstance->getEmitter();
+    connect(vidEmitter, &VideoEncoderEmitter::encodingFinished,
+            this, [this]() { finish(exitSuccess); });
+    connect(vidEmitter, &VideoEncoderEmitter::encodingInterrupted,
+            this, [this]() { finish(exitInterrupted, tr("Rendering interrupted.")); });
+    connect(vidEmitter, &VideoEncoderEmitter::encodingFailed,
+            this, [this]() { finish(exitRenderFailed, mSettings->getRenderError()); });
+    connect(vidEmitter, &VideoEncoderEmitter::encodingStartFailed,
+            this, [this]() { finish(exitRenderFailed, mSettings->getRenderError()); });
+    connect(mSettings, &RenderInstanceSettings::renderFrameChanged,
+            this, &HeadlessRenderer::setRenderedFrame);
+
+    *mLog << QString("Rendering scene \"%1\" frames %2-%3 (%4x%5) to %6").arg(
+                 scene->prp_getName(),
+                 QString::number(renderSettings.fMinFrame),
+                 QString::number(renderSettings.fMaxFrame),
+                 QString::number(renderSettings.fVideoWidth),
+                 QString::number(renderSettings.fVideoHeight),
+                 mSettings->getOutputDestination()).toStdString() << std::endl;
+
+    mTimer.start();
+    mRenderHandler.renderFromSettings(mSettings);
+    return true;
+}
+
+bool HeadlessRenderer::startChunks(const int chunks,
+                                   const QStringList &workerArgs)
+{
+    const auto &renderSettings = mSettings->getRenderSettings();
+    const auto &outputSettings = mSettings->getOutputRenderSettings();
+    const QString dst = mSettings->getOutputDestination();
+    const QByteArray dstPath = dst.toUtf8();
+    mChunksFormat = outputSettings.fOutputFormat ? outputSettings.fOutputFormat :
+                                                   av_guess_format(nullptr, dstPath.constData(), nullptr);
+    if (!mChunksFormat) {
+        finish(exitInvalidArgs, tr("Could not guess the output format of %1.").arg(dst));
+        return false;
+    }
+
+    // image sequences are written in place, other formats as segments
+    // in the same container, concatenated without re-encoding when done
+    const bool imageSequence = mChunksFormat->flags & AVFMT_NOFILE;
+    const QFileInfo dstInfo(dst);
+    if (!imageSequence) {
+        mChunksDir = QString("%1/.%2.chunks").arg(dstInfo.absolutePath(),
+                                                  dstInfo.fileName());
+        if (!QDir().mkpath(mChunksDir)) {
+            finish(exitRenderFailed, tr("Unable to create directory: %1").arg(mChunksDir));
+            return false;
+        }
+    }
+
+    // every worker gets an equal share of threads and memory
+    const int threads = qMax(1, eSettings::sCpuThreadsCapped()/chunks);
+    const int memory = qMax(1, eSettings::sRamMBCap().fValue/chunks);
+    const int firstNumber = formatOption(outputSettings, "start_number", 1);
+    const int minFrame = renderSettings.fMinFrame;
+    const int nFrames = renderSettings.fMaxFrame - minFrame + 1;
+
+    std::cout << QString("Rendering frames %1-%2 in %3 chunks (%4 threads, %5 MB each)").arg(
+                     QString::number(minFrame),
+                     QString::number(renderSettings.fMaxFrame),
+                     QString::number(chunks),
+                     QString::number(threads),
+                     QString::number(memory)).toStdString() << std::endl;
+
+    mTimer.start();
+    for (int i = 0; i < chunks; i++) {
+        const int first = minFrame + nFrames*i/chunks;
+        const int last = minFrame + nFrames*(i + 1)/chunks - 1;
+        QStringList args = workerArgs;
+        args << "--start" << QString::number(first)
+             << "--end" << QString::number(last)
+             << "--threads" << QString::number(threads)
+             << "--memory" << QString::number(memory);
+        if (imageSequence) {
+            args << "--output" << dst
+                 << "--start-number" << QString::number(firstNumber + first - minFrame);
+        } else {
+            const QString segment = QString("%1/%2.%3").arg(mChunksDir,
+                                                            QString::number(i).rightJustified(4, '0'),
+                                                            dstInfo.suffix());
+            mSegments << segment;
+            args << "--output" << segment;
+        }
+
+        startWorker(QString("%1/%2").arg(QString::number(i + 1),
+                                         QString::number(chunks)),
+                    args, [this, i](const int exitCode) {
+            workerFinished(i, exitCode);
+        });
+    }
+    return true;
+}
+
+bool HeadlessRenderer::startJobs(const int jobs,
+                                 const QStringList &workerArgs)
+{
+    for (int i = 0; i < mQueue.count(); i++) {
+        if (mQueueChecked.at(i)) { mPendingJobs << i; }
+    }
+    if (mPendingJobs.isEmpty()) {
+        finish(exitInvalidArgs, tr("No checked render queue items."));
+        return false;
+    }
+
+    // jobs share the machine the same way chunks do, the system
+    // schedules the workers and the thread caps keep them from starving
+    const int running = qMin(jobs, mPendingJobs.count());
+    const int threads = qMax(1, eSettings::sCpuThreadsCapped()/running);
+    const int memory = qMax(1, eSettings::sRamMBCap().fValue/running);
+    mJobArgs = workerArgs;
+    mJobArgs << "--threads" << QString::number(threads)
+             << "--memory" << QString::number(memory);
+
+    std::cout << QString("Rendering %1 render queue items, %2 at a time (%3 threads, %4 MB each)").arg(
+                     QString::number(mPendingJobs.count()),
+                     QString::number(running),
+                     QString::number(threads),
+                     QString::number(memory)).toStdString() << std::endl;
+
+    mTimer.start();
+    for (int i = 0; i < running; i++) { startNextJob(); }
+    return true;
+}
+
+void HeadlessRenderer::startNextJob()
+{
+    const int id = mPendingJobs.takeFirst();
+    QStringList args = mJobArgs;
+    args << "--queue" << QString::number(id + 1);
+    startWorker(QString("queue %1").arg(id + 1), args,
+                [this, id](const int exitCode) { jobFinished(id, exitCode); });
+}
+
+void HeadlessRenderer::jobFinished(const int id,
+                                   const int exitCode)
+{
+    if (mFinished) { return; }
+    // jobs are independent, a failed one does not stop the others
+    if (exitCode != exitSuccess) {
+        mFailedJobs << QString::number(id + 1);
+        std::cout << QString("Render queue item %1 failed with exit code %2").arg(
+                         QString::number(id + 1),
+                         QString::number(exitCode)).toStdString() << std::endl;
+    }
+    if (!mPendingJobs.isEmpty()) {
+        startNextJob();
+        return;
+    }
+    for (const auto worker : mWorkers) {
+        if (worker->state() != QProcess::NotRunning) { return; }
+    }
+    if (mFailedJobs.isEmpty()) { finish(exitSuccess); }
+    else {
+        finish(exitRenderFailed, tr("Render queue items %1 failed.").arg(
+                   mFailedJobs.join(", ")));
+    }
+}
+
+void HeadlessRenderer::startWorker(const QString &label,
+                                   const QStringList &args,
+                                   const std::function<void(int)> &finished)
+{
+    const auto worker = new QProcess(this);
+    worker->setProcessChannelMode(QProcess::MergedChannels);
+    connect(worker, &QProcess::readyRead, this, [worker, label]() {
+        while (worker->canReadLine()) {
+            const auto line = QString::fromUtf8(worker->readLine()).trimmed();
+            std::cout << QString("[%1] %2").arg(label, line).toStdString() << std::endl;
+        }
+    });
+    connect(worker, qOverload<int, QProcess::ExitStatus>(&QProcess::finished),
+            this, [finished](const int exitCode,
+                             const QProcess::ExitStatus exitStatus) {
+        finished(exitStatus == QProcess::NormalExit ? exitCode : -1);
+    });
+    mWorkers << worker;
+    worker->start(QApplication::applicationFilePath(), args);
+}
+
+void HeadlessRenderer::workerFinished(const int id,
+                                      const int exitCode)
+{
+    if (mFinished) { return; }
+    if (exitCode != exitSuccess) {
+        for (const auto worker : mWorkers) {
+            if (worker->state() != QProcess::NotRunning) { worker->kill(); }
+        }
+        finish(exitRenderFailed, tr("Chunk %1 failed with exit code %2.").arg(
+                   QString::number(id + 1), QString::number(exitCode)));
+        return;
+    }
+    for (const auto worker : mWorkers) {
+        if (worker->state() != QProcess::NotRunning) { return; }
+    }
+    if (!mSegments.isEmpty()) {
+        const QString dst = mSettings->getOutputDestination();
+        std::cout << QString("Concatenating %1 segments to %2").arg(
+                         QString::number(mSegments.count()), dst).toStdString() << std::endl;
+        try {
+            SegmentMuxer::sConcat(mSegments, dst, mChunksFormat);
+        } catch(const std::exception& e) {
+            finish(exitRenderFailed, gAllTextFromException(e));
+            return;
+        }
+        QDir(mChunksDir).removeRecursively();
+    }
+    finish(exitSuccess);
+}
+
+void HeadlessRenderer::loadProject(const QString &path)
+{
+    // same as MainWindow::loadEVFile, minus the user interface
+    QFile file(path);
+    if (!file.exists()) { RuntimeThrow("File does not exist " + path); }
+    if (!file.open(QIODevice::ReadOnly)) {
+        RuntimeThrow("Could not open file " + path);
+    }
+    try {
+        const int evVersion = FileFooter::sReadEvFileVersion(&file);
+        if (evVersion <= 0) { RuntimeThrow("Incompatible or incomplete data"); }
+        if (evVersion > EvFormat::version) {
+            RuntimeThrow(QString("Project version %1 is not supported, "
+                                 "max supported project version is %2").arg(
+                             QString::number(evVersion),
+                             QString::number(EvFormat::version)));
+        }
+
+        // read stream done tasks (render queue targets) run on destruction
+        eReadStream readStream(evVersion, &file);
+        readStream.setPath(path);
+
+        const qint64 savedPos = file.pos();
+        const qint64 pos = file.size() - FileFooter::sSize(evVersion) -
+                qint64(sizeof(int));
+        file.seek(pos);
+        readStream.readFutureTable();
+        file.seek(savedPos);
+        readStream.readCheckpoint("File beginning pos mismatch");
+        if (evVersion >= EvFormat::betterSWTAbsReadWrite) {
+            int nScenes; readStream >> nScenes;
+            for (int i = 0; i < nScenes; i++) {
+                const bool beforeContent = (evVersion >= EvFormat::readSceneSettingsBeforeContent);
+                const auto scene = mDocument.createNewScene(!beforeContent);
+                if (beforeContent) {
+                    scene->readSettings(readStream);
+                    mDocument.sceneCreated(scene);
+                }
+            }
+            // the window layout is of no use here
+            LayoutHandler::sSkip(readStream);
+            readStream.readCheckpoint("Error reading Layout");
+        }
+        mDocument.readScenes(readStream);
+        readStream.readCheckpoint("Error reading Document");
+        if (evVersion >= EvFormat::betterSWTAbsReadWrite) {
+            // see RenderWidget::read and RenderInstanceWidget::read
+            int nQueued; readStream >> nQueued;
+            for (int i = 0; i < nQueued; i++) {
+                const auto settings = new RenderInstanceSettings(nullptr);
+                settings->setParent(this);
+                settings->read(readStream);
+                bool checked; readStream >> checked;
+                mQueue << settings;
+                mQueueChecked << checked;
+            }
+            readStream.readCheckpoint("Error reading Render Widget");
+        }
+    } catch(...) {
+        file.close();
+        RuntimeThrow("Error while reading from file " + path);
+    }
+    file.close();
+    mDocument.setPath(path);
+}
+
+void HeadlessRenderer::printInfo() const
+{
+    std::cout << "Scenes:" << std::endl;
+    for (int i = 0; i < mDocument.fScenes.count(); i++) {
+        const auto scene = mDocument.fScenes.at(i).get();
+        const auto range = scene->getFrameRange();
+        std::cout << QString("  %1: \"%2\" %3x%4 %5 fps, frames %6-%7").arg(
+                         QString::number(i + 1),
+                         scene->prp_getName(),
+                         QString::number(scene->getCanvasWidth()),
+                         QString::number(scene->getCanvasHeight()),
+                         QString::number(scene->getFps()),
+                         QString::number(range.fMin),
+                         QString::number(range.fMax)).toStdString() << std::endl;
+    }
+    std::cout << "Render queue:" << std::endl;
+    for (int i = 0; i < mQueue.count(); i++) {
+        const auto settings = mQueue.at(i);
+        const auto profile = settings->getOutputSettingsProfile();
+        std::cout << QString("  %1: [%2] \"%3\" %4 -> %5").arg(
+                         QString::number(i + 1),
+                         mQueueChecked.at(i) ? "x" : " ",
+                         settings->getName(),
+                         profile ? profile->getName() : "-",
+                         settings->getOutputDestination()).toStdString() << std::endl;
+    }
+    std::cout << "Output profiles:" << std::endl;
+    for (const auto &profile : OutputSettingsProfile::sOutputProfiles) {
+        std::cout << QString("  \"%1\"").arg(profile->getName()).toStdString() << std::endl;
+    }
+}
+
+Canvas *HeadlessRenderer::findScene(const QString &id) const
+{
+    for (const auto &scene : mDocument.fScenes) {
+        if (scene->prp_getName() == id) { return scene.get(); }
+    }
+    bool isIndex = false;
+    const int index = id.toInt(&isIndex) - 1;
+    if (!isIndex || index < 0 || index >= mDocument.fScenes.count()) {
+        return nullptr;
+    }
+    return mDocument.fScenes.at(index).get();
+}
+
+OutputSettingsProfile *HeadlessRenderer::findProfile(const QString &id)
+{
+    if (const auto profile = OutputSettingsProfile::sGetByName(id)) {
+        return profile;
+    }
+    if (!QFileInfo(id).isFile()) { return nullptr; }
+    const auto profile = enve::make_shared<OutputSettingsProfile>();
+    try {
+        profile->load(QFileInfo(id).absoluteFilePath());
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+        return nullptr;
+    }
+    mFileProfile = profile;
+    return profile.get();
+}
+
+void HeadlessRenderer::setRenderedFrame(const int frame)
+{
+    const auto &renderSettings = mSettings->getRenderSettings();
+    const int total = renderSettings.fMaxFrame - renderSettings.fMinFrame + 1;
+    const int done = qBound(0, frame - renderSettings.fMinFrame + 1, total);
+    const int percent = done*100/total;
+    if (percent == mLastPercent) { return; }
+    mLastPercent = percent;
+
+    const qreal secs = mTimer.elapsed()/1000.;
+    const qreal fps = secs > 0 ? done/secs : 0;
+    const int eta = fps > 0 ? qRound((total - done)/fps) : 0;
+    *mLog << QString("Rendering frame %1/%2 (%3%) %4 fps, ETA %5s").arg(
+                 QString::number(done),
+                 QString::number(total),
+                 QString::number(percent),
+                 QString::number(fps, 'f', 1),
+                 QString::number(eta)).toStdString() << std::endl;
+}
+
+void HeadlessRenderer::finish(const ExitCode code,
+                              const QString &message)
+{
+    if (mFinished) { return; }
+    mFinished = true;
+    mExitCode = code;
+    if (code == exitSuccess) {
+        if (mTimer.isValid()) {
+            *mLog << QString("Finished in %1s").arg(
+                         QString::number(mTimer.elapsed()/1000., 'f', 1)).toStdString() << std::endl;
+        }
+    } else if (!message.isEmpty()) {
+        std::cerr << message.toStdString() << std::endl;
+    }
+    // exit() is ignored before QApplication::exec(), so que it
+    QTimer::singleShot(0, qApp, [code]() { QApplication::exit(code); });
+}
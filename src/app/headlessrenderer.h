@@ -0,0 +1,113 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef HEADLESSRENDERER_H
+#define HEADLESSRENDERER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <iostream>
+#include <functional>
+
+#include "smartPointers/ememory.h"
+
+class Canvas;
+class Document;
+class RenderHandler;
+class RenderInstanceSettings;
+class OutputSettingsProfile;
+struct AVOutputFormat;
+
+//! @brief Renders a project from the command line (--renderer),
+//! without creating MainWindow or any other window.
+class HeadlessRenderer : public QObject {
+    Q_OBJECT
+public:
+    enum ExitCode {
+        exitSuccess = 0,
+        exitInvalidArgs = 1,
+        exitLoadFailed = 2,
+        exitRenderFailed = 3,
+        exitInterrupted = 4
+    };
+
+    HeadlessRenderer(Document &document,
+                     RenderHandler &renderHandler);
+
+    //! @brief Parses args, loads the project and starts rendering.
+    //! Returns false if there is nothing left to do, see exitCode().
+    bool start(const QStringList &args);
+
+    int exitCode() const { return mExitCode; }
+private:
+    void loadProject(const QString &path);
+    void printInfo() const;
+
+    bool startChunks(const int chunks,
+                     const QStringList &workerArgs);
+    void workerFinished(const int id,
+                        const int exitCode);
+
+    bool startJobs(const int jobs,
+                   const QStringList &workerArgs);
+    void startNextJob();
+    void jobFinished(const int id,
+                     const int exitCode);
+
+    void startWorker(const QString &label,
+                     const QStringList &args,
+                     const std::function<void(int)> &finished);
+
+    Canvas *findScene(const QString &id) const;
+    OutputSettingsProfile *findProfile(const QString &id);
+
+    void setRenderedFrame(const int frame);
+    void finish(const ExitCode code,
+                const QString &message = QString());
+
+    Document &mDocument;
+    RenderHandler &mRenderHandler;
+
+    QList<RenderInstanceSettings*> mQueue;
+    QList<bool> mQueueChecked;
+    qsptr<OutputSettingsProfile> mFileProfile;
+    RenderInstanceSettings *mSettings = nullptr;
+
+    QList<QProcess*> mWorkers;
+    QStringList mSegments;
+    QString mChunksDir;
+    const AVOutputFormat *mChunksFormat = nullptr;
+
+    QStringList mJobArgs;
+    QList<int> mPendingJobs;
+    QStringList mFailedJobs;
+
+    QElapsedTimer mTimer;
+    int mLastPercent = -1;
+    std::ostream *mLog = &std::cout; // stderr when frames go to stdout
+    int mExitCode = exitSuccess;
+    bool mFinished = false;
+};
+
+#endif // HEADLESSRENDERER_H
@@ -25,6 +25,7 @@
 #include <QApplication>
 #include <QSurfaceFormat>
 #include <QDesktopWidget>
+#include <QDebug>
 
 #include "hardwareinfo.h"
 #include "Private/esettings.h"
@@ -36,6 +37,7 @@
 #include "videoencoder.h"
 #include "appsupport.h"
 #include "themesupport.h"
+#include "headlessrenderer.h"
 
 #ifdef Q_OS_WIN
 #include <QSplashScreen>
@@ -76,14 +78,27 @@ void generateAlphaMesh(QPixmap& alphaMesh,
 
 int main(int argc, char *argv[])
 {
-    // check if cli renderer (not supported yet)
-    const bool isRenderer = false; // AppSupport::hasArg(argc, argv, "--renderer");
+    // check if cli renderer
+    const bool isRenderer = AppSupport::hasArg(argc, argv, "--renderer");
+    if (isRenderer) { gSetExceptionDialogs(false); }
+
+    // use software (CPU) OpenGL, when forced
+    const bool softwareGL = AppSupport::useSoftwareGL(argc, argv);
+
+    // no display server, fail now rather than later in the OpenGL setup
+    if (!AppSupport::initHeadless(isRenderer, softwareGL)) {
+        std::cerr << (isRenderer ? "No display found, and no GPU render node or "
+                                   "Xvfb to render with."
+                                 : "No display found, use --renderer to render "
+                                   "without user interface.") << std::endl;
+        return 1;
+    }
 
     // init env variables
-    AppSupport::initEnv(isRenderer);
+    AppSupport::initEnv(isRenderer, softwareGL);
 
     // version info
-    AppSupport::printVersion();
+    AppSupport::printVersion(isRenderer);
 
     // init app
     QApplication::setApplicationDisplayName(AppSupport::getAppDisplayName());
@@ -98,7 +113,8 @@ int main(int argc, char *argv[])
 #endif
     QApplication::setHighDpiScaleFactorRoundingPolicy(Qt::HighDpiScaleFactorRoundingPolicy::PassThrough);
     QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
-    QApplication::setAttribute(isRenderer ? Qt::AA_UseSoftwareOpenGL : Qt::AA_UseDesktopOpenGL);
+    // Windows-only, loads opengl32sw (Mesa llvmpipe) instead of the driver
+    QApplication::setAttribute(softwareGL ? Qt::AA_UseSoftwareOpenGL : Qt::AA_UseDesktopOpenGL);
 
     setDefaultFormat();
     QApplication app(argc, argv);
@@ -153,6 +169,9 @@ int main(int argc, char *argv[])
         GPU_NOT_COMPATIBLE;
         gPrintExceptionCritical(e);
     }
+    if (HardwareInfo::sGpuIsSoftware()) {
+        qWarning() << "Using software OpenGL:" << HardwareInfo::sGpuRendererString();
+    }
 
     // init settings
     eSettings settings(HardwareInfo::sCpuThreads(),
@@ -205,7 +224,7 @@ int main(int argc, char *argv[])
     AppSupport::checkPerms(isRenderer);
 
     // portable
-    AppSupport::handlePortableFirstRun();
+    if (!isRenderer) { AppSupport::handlePortableFirstRun(); }
 
     // check XDG integration
 #ifdef Q_OS_LINUX
@@ -318,6 +337,20 @@ int main(int argc, char *argv[])
     // check for ffmpeg version
     AppSupport::checkFFmpeg(isRenderer);
 
+    // render without user interface
+    if (isRenderer) {
+        HeadlessRenderer renderer(document, renderHandler);
+        if (!renderer.start(QApplication::arguments())) {
+            return renderer.exitCode();
+        }
+        try {
+            return app.exec();
+        } catch(const std::exception& e) {
+            gPrintExceptionCritical(e);
+            return HeadlessRenderer::exitRenderFailed;
+        }
+    }
+
 #ifdef Q_OS_WIN
     splash.raise();
     splash.setPixmap(QPixmap(":/icons/splash/splash-00006.png"));
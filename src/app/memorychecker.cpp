@@ -52,6 +52,7 @@
 
 #include "exceptions.h"
 #include "hardwareinfo.h"
+#include "renderstats.h"
 MemoryChecker *MemoryChecker::mInstance;
 
 MemoryChecker::MemoryChecker(QObject * const parent) : QObject(parent) {
@@ -138,6 +139,7 @@ void MemoryChecker::sGetFreeKB(intKB& procFreeKB, intKB& sysFreeKB)
 #endif
 
     const intKB enveUsedKB(enveUsedB);
+    RenderStats::sMemoryUsed(enveUsedB.fValue);
     if (usageCap.fValue > 0) {
         procFreeKB = intKB(usageCap) - enveUsedKB;
     } else {
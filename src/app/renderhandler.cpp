@@ -70,9 +70,19 @@ RenderHandler::RenderHandler(Document &document,
             this, &RenderHandler::interruptOutputRendering);
 }
 
-void RenderHandler::renderFromSettings(RenderInstanceSettings * const settings) {
+QList<RenderInstanceSettings*> RenderHandler::renderFromSettings(
+        RenderInstanceSettings * const settings,
+        const QList<RenderInstanceSettings*> &outputs) {
     setCurrentScene(settings->getTargetCanvas());
+    QList<RenderInstanceSettings*> rejected;
     if(VideoEncoder::sStartEncoding(settings)) {
+        for(const auto output : outputs) {
+            // outputs that failed to start are already set to error
+            if(!VideoEncoder::sAddOutput(output) &&
+               output->getCurrentState() != RenderState::error) {
+                rejected << output;
+            }
+        }
         mSavedCurrentFrame = mCurrentScene->getCurrentFrame();
         mSavedResolutionFraction = mCurrentScene->getResolution();
 
@@ -117,7 +127,8 @@ void RenderHandler::renderFromSettings(RenderInstanceSettings * const settings)
                 nextSaveOutputFrame();
             }
         }
-    }
+    } else rejected = outputs;
+    return rejected;
 }
 
 void RenderHandler::setLoop(const bool loop) {
@@ -392,6 +403,8 @@ void RenderHandler::nextSaveOutputFrame() {
         }
     } else {
         mCurrentRenderSettings->setCurrentRenderFrame(mCurrentRenderFrame);
+        // resumed from the scheduler once the encoder drains its queue
+        if(VideoEncoder::sEncodeQueueFull()) return;
         nextCurrentRenderFrame();
         if(TaskScheduler::sAllTasksFinished()) {
             nextSaveOutputFrame();
@@ -60,7 +60,11 @@ public:
     void pausePreview();
     void resumePreview();
     void renderPreview();
-    void renderFromSettings(RenderInstanceSettings * const settings);
+    //! @brief outputs are encoded from the same rendered frames,
+    //! see VideoEncoder::sCanShareRender. Returns the outputs that were not
+    //! started (and not failed), they have to be rendered on their own.
+    QList<RenderInstanceSettings*> renderFromSettings(RenderInstanceSettings * const settings,
+                                                      const QList<RenderInstanceSettings*> &outputs = {});
 
     void setLoop(const bool loop);
 
@@ -27,6 +27,7 @@
 
 #include <QMenu>
 #include <QInputDialog>
+#include <QtMath>
 
 #include "canvas.h"
 #include "FileCacheHandlers/animationcachehandler.h"
@@ -49,6 +50,7 @@ struct AnimationBoxRenderData : public ImageContainerRenderData {
 
     const qptr<AnimationFrameHandler> fSrcCacheHandler;
     int fAnimFrame;
+    int fDownscale = 1;
 };
 
 AnimationBox::AnimationBox(const QString &name, const eBoxType type) :
@@ -312,10 +314,24 @@ void AnimationBox::setupRenderData(const qreal relFrame,
     const auto imgData = static_cast<AnimationBoxRenderData*>(data);
     const int animFrame = getAnimationFrameForRelFrame(relFrame);
     imgData->fAnimFrame = animFrame;
-    const auto upd = mSrcFramesCache->scheduleFrameLoad(animFrame);
+    const bool preview = !scene || !scene->isOutputRendering();
+    int downscale = 1;
+    if(preview) {
+        const auto& m = data->fTotalTransform;
+        const qreal boxScale = qMax(qSqrt(m.m11()*m.m11() + m.m12()*m.m12()),
+                                    qSqrt(m.m21()*m.m21() + m.m22()*m.m22()));
+        const qreal scale = boxScale*data->fResolution;
+        downscale = AnimationFrameHandler::sDownscaleForScale(scale);
+    }
+    downscale = mSrcFramesCache->frameDownscale(downscale, preview);
+    imgData->fDownscale = downscale;
+    imgData->fImageScale = 1./downscale;
+    const auto upd = mSrcFramesCache->scheduleScaledFrameLoad(animFrame,
+                                                              downscale);
     if(upd) upd->addDependent(imgData);
     else {
-        const auto cont = mSrcFramesCache->getFrameAtFrame(animFrame);
+        const auto cont = mSrcFramesCache->getScaledFrameAtFrame(animFrame,
+                                                                 downscale);
         imgData->setContainer(cont);
     }
 }
@@ -341,6 +357,7 @@ AnimationBoxRenderData::AnimationBoxRenderData(
 
 void AnimationBoxRenderData::loadImageFromHandler() {
     if(!fSrcCacheHandler) return;
-    const auto cont = fSrcCacheHandler->getFrameAtOrBeforeFrame(fAnimFrame);
+    const auto cont = fSrcCacheHandler->getScaledFrameAtOrBeforeFrame(
+                fAnimFrame, fDownscale);
     setContainer(cont);
 }
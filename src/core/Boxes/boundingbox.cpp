@@ -60,6 +60,7 @@
 #include <QMessageBox>
 
 int BoundingBox::sNextDocumentId = 0;
+uint BoundingBox::sLastRenderStateId = 0;
 QList<BoundingBox*> BoundingBox::sDocumentBoxes;
 int BoundingBox::sNextWriteId;
 QList<const BoundingBox*> BoundingBox::sBoxesWithWriteIds;
@@ -103,6 +104,9 @@ BoundingBox::BoundingBox(const QString& name, const eBoxType type) :
     });
     connect(mBlendEffectCollection.get(), &Property::prp_currentFrameChanged,
             this, &BoundingBox::blendEffectChanged);
+    mRenderStateId = ++sLastRenderStateId;
+    connect(this, &Property::prp_absFrameRangeChanged,
+            this, [this]() { mRenderStateId = ++sLastRenderStateId; });
 }
 
 BoundingBox::~BoundingBox() {
@@ -132,6 +136,19 @@ qreal BoundingBox::getOpacity(const qreal relFrame) const {
     return mTransformAnimator->getOpacity(relFrame);
 }
 
+quint64 BoundingBox::renderStateKey(const qreal relFrame) const {
+    const int frame = qFloor(relFrame);
+    const auto idRange = prp_getIdenticalRelRange(frame);
+    const bool identical = idRange.inRange(frame) &&
+                           idRange.inRange(qCeil(relFrame));
+    const qreal keyFrame = identical ? idRange.fMin : relFrame;
+    const uint seed = qHash(reinterpret_cast<quintptr>(this));
+    const uint low = qHash(keyFrame, qHash(mRenderStateId, seed));
+    const uint high = qHash(mRenderStateId, qHash(keyFrame, seed + 1));
+    const quint64 result = (static_cast<quint64>(high) << 32) | low;
+    return result ? result : 1;
+}
+
 void BoundingBox::prp_readPropertyXEV_impl(const QDomElement& ele,
                                            const XevImporter& imp) {
     const auto readIdStr = ele.attribute("id");
@@ -1062,6 +1079,7 @@ void BoundingBox::setupWithoutRasterEffects(const qreal relFrame,
     if(!scene) return;
 
     data->fBoxStateId = mStateId;
+    data->fRenderStateKey = renderStateKey(relFrame);
     data->fRelFrame = relFrame;
 
     const auto thisRelM = getRelativeTransformAtFrame(relFrame);
@@ -117,6 +117,7 @@ public:
 private:
     static int sNextDocumentId;
     static QList<BoundingBox*> sDocumentBoxes;
+    static uint sLastRenderStateId;
 
     static int sNextWriteId;
     static QList<const BoundingBox*> sBoxesWithWriteIds;
@@ -233,6 +234,10 @@ public:
 
     virtual qreal getOpacity(const qreal relFrame) const;
 
+    //! @brief Identifies the image rendered at relFrame before raster
+    //! effects, up to the transform, 0 if the pixels have to be hashed
+    virtual quint64 renderStateKey(const qreal relFrame) const;
+
     virtual void saveSVG(SvgExporter& exp, DomEleTask* const task) const {
         Q_UNUSED(exp)
         Q_UNUSED(task)
@@ -461,6 +466,8 @@ protected:
     void setRelBoundingRect(const QRectF& relRect);
 
     uint mStateId = 0;
+    //! @brief Unique among all boxes, changes with any change in any frame
+    uint mRenderStateId = 0;
 
     int mNReasonsNotToApplyUglyTransform = 0;
 protected:
@@ -29,6 +29,7 @@
 #include "efiltersettings.h"
 #include "Private/Tasks/taskscheduler.h"
 #include "Private/Tasks/gputaskexecutor.h"
+#include "renderstats.h"
 
 BoxRenderData::BoxRenderData(BoundingBox * const parent) :
     fFilterQuality(eFilterSettings::sRender()) {
@@ -60,6 +61,7 @@ void BoxRenderData::copyFrom(BoxRenderData *src) {
     fResolutionScale = src->fResolutionScale;
     fRenderedImage = src->requestImageCopy();
     fBoxStateId = src->fBoxStateId;
+    fRenderStateKey = src->fRenderStateKey;
     mState = eTaskState::finished;
     fRelBoundingRectSet = true;
 }
@@ -166,12 +168,20 @@ void BoxRenderData::process() {
 void BoxRenderData::beforeProcessing(const Hardware hw) {
     Q_UNUSED(hw)
     Q_ASSERT(mStep != Step::EFFECTS);
-    setupRenderData();
+    {
+        const RenderStats::Timer timer(RenderStats::Stage::setup);
+        setupRenderData();
+    }
     if(!mDataSet) dataSet();
     if(isZero4Dec(fOpacity)) finishedProcessing();
 }
 
 void BoxRenderData::afterProcessing() {
+    if(mEffectResultCached) {
+        EffectResultCache::sTouch(mEffectResultKey);
+    } else if(mEffectResultKey.isValid() && mEffectsRenderer.isEmpty()) {
+        EffectResultCache::sStore(mEffectResultKey, fRenderedImage);
+    }
     if(fMotionBlurTarget) {
         fMotionBlurTarget->fOtherGlobalRects << fGlobalRect;
     }
@@ -203,6 +213,7 @@ void BoxRenderData::queTaskNow() {
 }
 
 bool BoxRenderData::nextStep() {
+    if(mStep == Step::BOX_IMAGE) loadCachedEffectResult();
     const bool result = !mEffectsRenderer.isEmpty() &&
                         fRenderedImage;
     if(result) {
@@ -216,6 +227,24 @@ bool BoxRenderData::nextStep() {
     return result;
 }
 
+void BoxRenderData::loadCachedEffectResult() {
+    if(!fRenderedImage || fRenderedImage->isTextureBacked()) return;
+    if(!mEffectsRenderer.cacheable()) return;
+    if(!mEffectsRenderer.notStarted()) return;
+    // the pixels get hashed only when the box state cannot identify them
+    mEffectResultKey.fInput = fRenderStateKey ?
+                EffectResultKey::sHashState(fRenderStateKey, fTotalTransform) :
+                EffectResultKey::sHashPixels(fRenderedImage);
+    mEffectResultKey.fEffects = mEffectsRenderer.cacheKey();
+    mEffectResultKey.fGlobalRect = fGlobalRect;
+    mEffectResultKey.fResolution = fResolution;
+    const auto cached = EffectResultCache::sLookup(mEffectResultKey);
+    if(!cached) return;
+    fRenderedImage = cached;
+    mEffectsRenderer.skipAll();
+    mEffectResultCached = true;
+}
+
 void BoxRenderData::dataSet() {
     if(mDataSet) return;
     mDataSet = true;
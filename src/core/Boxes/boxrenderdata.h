@@ -35,6 +35,7 @@ class BoundingBox;
 class ShaderProgramCallerBase;
 #include "smartPointers/ememory.h"
 #include "effectsrenderer.h"
+#include "CacheHandlers/effectresultcache.h"
 
 class RenderDataCustomizerFunctor;
 struct CORE_EXPORT BoxRenderData : public eTask {
@@ -86,6 +87,8 @@ public:
     bool fForceRasterize = false;
 
     uint fBoxStateId = 0;
+    //! @brief BoundingBox::renderStateKey() of the rendered frame
+    quint64 fRenderStateKey = 0;
 
     QMatrix fResolutionScale;
     QMatrix fScaledTransform;
@@ -125,6 +128,11 @@ public:
     void addEffect(const stdsptr<RasterEffectCaller>& effect) {
         mEffectsRenderer.add(effect);
     }
+
+    void addEffect(const stdsptr<RasterEffectCaller>& effect,
+                   const uint cacheKey) {
+        mEffectsRenderer.add(effect, cacheKey);
+    }
 protected:
     bool hasEffects() const { return !mEffectsRenderer.isEmpty(); }
 
@@ -139,8 +147,12 @@ private:
         mImageCopies << img;
     }
 
+    void loadCachedEffectResult();
+
     Step mStep = Step::BOX_IMAGE;
     EffectsRenderer mEffectsRenderer;
+    EffectResultKey mEffectResultKey;
+    bool mEffectResultCached = false;
     stdptr<BoxRenderData> mCopySource;
     QList<sk_sp<SkImage>> mImageCopies;
 };
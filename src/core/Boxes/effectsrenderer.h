@@ -35,6 +35,13 @@ struct BoxRenderData;
 class CORE_EXPORT EffectsRenderer {
 public:
     void add(const stdsptr<RasterEffectCaller>& effect) {
+        mCacheable = false;
+        mEffects.append(effect);
+    }
+
+    void add(const stdsptr<RasterEffectCaller>& effect,
+             const uint cacheKey) {
+        mCacheKey = (mCacheKey ^ cacheKey)*0x100000001b3ULL;
         mEffects.append(effect);
     }
 
@@ -44,6 +51,13 @@ public:
     void processCpu(BoxRenderData * const boxData);
 
     bool isEmpty() const { return mCurrentId >= mEffects.count(); }
+    //! @brief True if no effect has been applied yet
+    bool notStarted() const { return mCurrentId == 0; }
+    //! @brief Marks all effects as applied, e.g., on a cache hit
+    void skipAll() { mCurrentId = mEffects.count(); }
+
+    bool cacheable() const { return mCacheable && !mEffects.isEmpty(); }
+    quint64 cacheKey() const { return mCacheKey; }
 
     void setBaseGlobalRect(SkIRect& currRect,
                            const SkIRect& skMaxBounds) const;
@@ -51,6 +65,8 @@ public:
     HardwareSupport nextHardwareSupport() const;
 private:
     int mCurrentId = 0;
+    bool mCacheable = true;
+    quint64 mCacheKey = 0xcbf29ce484222325ULL;
     QList<stdsptr<RasterEffectCaller>> mEffects;
 };
 #endif // EFFECTSRENDERER_H
@@ -36,17 +36,21 @@ public:
     EffectSubTaskSpawner_priv(const stdsptr<RasterEffectCaller>& effect,
                               const stdsptr<BoxRenderData>& data) :
         mUseDst(effect->srcDstSeparation()),
+        mPassCount(qMax(1, effect->cpuPasses())),
         mEffectCaller(effect), mData(data) {}
 
     void initialize();
 private:
     void decRemaining_k();
+    void nextPass();
     void spawn();
     void splitSpawn(CpuRenderData& data,
                     const SkIRect& rect,
                     const int nSplits);
 
     const bool mUseDst;
+    const int mPassCount;
+    int mPass = 0;
     int mRemaining = 0;
     const stdsptr<RasterEffectCaller> mEffectCaller;
     const stdsptr<BoxRenderData> mData;
@@ -75,6 +79,7 @@ void EffectSubTaskSpawner_priv::splitSpawn(CpuRenderData& data,
         const auto decRemaining = [this]() { decRemaining_k(); };
         const auto subTask = enve::make_shared<eCustomCpuTask>(nullptr,
             [this, data]() {
+                const RenderStats::Timer timer(RenderStats::Stage::effects);
                 SkBitmap dstBitmap;
                 if(mUseDst) {
                     mDstBitmap.extractSubset(&dstBitmap, data.fTexTile);
@@ -129,13 +134,34 @@ void EffectSubTaskSpawner_priv::spawn() {
     data.fPos = mData->fGlobalRect.topLeft();
     data.fWidth = static_cast<uint>(srcWidth);
     data.fHeight = static_cast<uint>(srcHeight);
+    data.fPass = mPass;
+    data.fPassCount = mPassCount;
+    data.fThreads = nThreads;
 
     splitSpawn(data, srcImage->bounds(), nThreads);
 }
 
+void EffectSubTaskSpawner_priv::nextPass() {
+    // output of the finished pass becomes the source of the next one
+    if(mUseDst) {
+        if(mPass == 1) {
+            mSrcBitmap = mDstBitmap;
+            mDstBitmap = SkBitmap();
+            mDstBitmap.allocPixels(mSrcBitmap.info());
+        } else {
+            std::swap(mSrcBitmap, mDstBitmap);
+        }
+    }
+    spawn();
+}
+
 void EffectSubTaskSpawner_priv::decRemaining_k() {
     if(--mRemaining > 0) return;
     if(mData->getState() != eTaskState::canceled) {
+        if(++mPass < mPassCount) {
+            nextPass();
+            return;
+        }
         if(mUseDst) {
             mData->fRenderedImage = SkiaHelpers::transferDataToSkImage(
                                         mDstBitmap);
@@ -26,8 +26,11 @@
 #include "Boxes/imagebox.h"
 
 #include <QMenu>
+#include <QtMath>
 
 #include "FileCacheHandlers/imagecachehandler.h"
+#include "FileCacheHandlers/animationcachehandler.h"
+#include "canvas.h"
 #include "fileshandler.h"
 #include "filesourcescache.h"
 #include "GUI/edialogs.h"
@@ -35,6 +38,7 @@
 //#include "paintbox.h"
 #include "svgexporter.h"
 #include "svgexporthelpers.h"
+#include "CacheHandlers/tiledimage.h"
 
 ImageFileHandler* imageFileHandlerGetter(const QString& path) {
     return FilesHandler::sInstance->getFileHandler<ImageFileHandler>(path);
@@ -139,10 +143,28 @@ void ImageBox::setupRenderData(const qreal relFrame, const QMatrix& parentM,
     if (!mFileHandler) { mFileHandler.assign(mPath); }
     BoundingBox::setupRenderData(relFrame, parentM, data, scene);
     const auto imgData = static_cast<ImageBoxRenderData*>(data);
-    if (mFileHandler->hasImage()) {
-        imgData->setContainer(mFileHandler->getImageContainer());
+    int downscale = 1;
+    if (!scene || !scene->isOutputRendering()) {
+        const auto& m = data->fTotalTransform;
+        const qreal boxScale = qMax(qSqrt(m.m11()*m.m11() + m.m12()*m.m12()),
+                                    qSqrt(m.m21()*m.m21() + m.m22()*m.m22()));
+        const qreal scale = boxScale*data->fResolution;
+        downscale = AnimationFrameHandler::sDownscaleForScale(scale);
+    }
+    const int loaded = mFileHandler->loadedDownscale(downscale);
+    if (loaded) {
+        imgData->fDownscale = loaded;
+        imgData->fImageScale = 1./loaded;
+        const auto tiled = mFileHandler->getScaledTiledImage(loaded);
+        if (tiled) { imgData->setTiledImage(tiled, true); }
+        else {
+            const auto cont = mFileHandler->getScaledImageContainer(loaded);
+            imgData->setContainer(cont);
+        }
     } else {
-        const auto loader = mFileHandler->scheduleLoad();
+        imgData->fDownscale = downscale;
+        imgData->fImageScale = 1./downscale;
+        const auto loader = mFileHandler->scheduleScaledLoad(downscale, true);
         if (loader) { loader->addDependent(imgData); }
     }
 }
@@ -153,6 +175,15 @@ stdsptr<BoxRenderData> ImageBox::createRenderData()
     return enve::make_shared<ImageBoxRenderData>(mFileHandler, this);
 }
 
+// huge sources are only kept as tiles, decode them whole for the export
+static sk_sp<SkImage> svgSourceImage(const ImageFileHandler* const handler) {
+    const auto tiled = handler->getScaledTiledImage(1);
+    if(!tiled) return handler->getImage();
+    const auto image = tiled->decodeWhole();
+    if(!image) qWarning() << "Could not decode" << handler->path() << "for SVG export";
+    return image;
+}
+
 void ImageBox::saveSVG(SvgExporter& exp, DomEleTask* const eleTask) const {
     const QString imageId = SvgExportHelpers::ptrToStr(mFileHandler.data());
     const auto expPtr = &exp;
@@ -163,7 +194,7 @@ void ImageBox::saveSVG(SvgExporter& exp, DomEleTask* const eleTask) const {
         use.setAttribute("href", "#" + imageId);
     };
     if(mFileHandler->hasImage()) {
-        const auto image = mFileHandler->getImage();
+        const auto image = svgSourceImage(mFileHandler.data());
         generate(image);
     } else {
         const auto task = mFileHandler->scheduleLoad();
@@ -173,7 +204,7 @@ void ImageBox::saveSVG(SvgExporter& exp, DomEleTask* const eleTask) const {
         task->addDependent(
         {[thisPtr, eleTaskPtr, imageId, generate]() {
              if(!eleTaskPtr || !thisPtr) return;
-             const auto image = thisPtr->mFileHandler->getImage();
+             const auto image = svgSourceImage(thisPtr->mFileHandler.data());
              generate(image);
          }, nullptr});
         task->addDependent(eleTask);
@@ -181,7 +212,9 @@ void ImageBox::saveSVG(SvgExporter& exp, DomEleTask* const eleTask) const {
 }
 
 void ImageBoxRenderData::loadImageFromHandler() {
-    if(fSrcCacheHandler) {
-        setContainer(fSrcCacheHandler->getImageContainer());
-    }
+    if(!fSrcCacheHandler) return;
+    const auto tiled = fSrcCacheHandler->getScaledTiledImage(fDownscale);
+    // too late to wait for tmp files, missing tiles decode while rendering
+    if(tiled) setTiledImage(tiled, false);
+    else setContainer(fSrcCacheHandler->getScaledImageContainer(fDownscale));
 }
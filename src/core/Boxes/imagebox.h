@@ -39,6 +39,7 @@ struct CORE_EXPORT ImageBoxRenderData : public ImageContainerRenderData {
 
     void loadImageFromHandler();
 
+    int fDownscale = 1;
     const qptr<ImageFileHandler> fSrcCacheHandler;
 };
 
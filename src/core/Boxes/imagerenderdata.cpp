@@ -32,13 +32,60 @@ ImageRenderData::ImageRenderData(BoundingBox * const parentBoxT) :
 
 void ImageRenderData::updateRelBoundingRect() {
     if(fImage) fRelBoundingRect =
-            QRectF(0, 0, fImage->width(), fImage->height());
+            QRectF(0, 0, fImage->width()/fImageScale,
+                   fImage->height()/fImageScale);
+    else if(fYuvImage) fRelBoundingRect =
+            QRectF(0, 0, fYuvImage->width()/fImageScale,
+                   fYuvImage->height()/fImageScale);
+    else if(fTiledImage) fRelBoundingRect =
+            QRectF(0, 0, fTiledImage->size().width()/fImageScale,
+                   fTiledImage->size().height()/fImageScale);
     else fRelBoundingRect = QRectF(0, 0, 0, 0);
 }
 
 void ImageRenderData::setupRenderData() {
-    if(!fImage) loadImageFromHandler();
-    if(!fForceRasterize && !hasEffects()) setupDirectDraw();
+    if(!fImage && !fYuvImage && !fTiledImage) loadImageFromHandler();
+    // pick up tiles loaded from tmp files since setTiledImage
+    for(auto& tile : fTiles) {
+        if(!tile.second) tile.second = fTiledImage->getTile(tile.first);
+    }
+    // YUV and tiled sources are converted in the render task
+    if(!fForceRasterize && !hasEffects() && !fYuvImage && !fTiledImage) {
+        setupDirectDraw();
+    }
+}
+
+void ImageRenderData::afterProcessing() {
+    for(const int tile : mDecodedTiles) {
+        fTiledImage->setTile(tile, fTiles[tile]);
+    }
+    mDecodedTiles.clear();
+    BoxRenderData::afterProcessing();
+}
+
+void ImageRenderData::setTiledImage(const stdsptr<TiledImage>& tiled,
+                                    const bool loadTmp) {
+    fTiledImage = tiled;
+    fTiles.clear();
+    if(!tiled) return;
+    QMatrix levelToGlobal;
+    levelToGlobal.scale(1/fImageScale, 1/fImageScale);
+    levelToGlobal = levelToGlobal*fTotalTransform*fResolutionScale;
+    QRect visible(QPoint(0, 0), tiled->size());
+    bool invertible = false;
+    const auto globalToLevel = levelToGlobal.inverted(&invertible);
+    if(invertible) {
+        const auto bounds = globalToLevel.mapRect(QRectF(fMaxBoundsRect));
+        visible = visible.intersected(
+                    bounds.toAlignedRect().adjusted(-2, -2, 2, 2));
+    }
+    for(const int tile : tiled->tilesIn(visible)) {
+        const auto image = tiled->getTile(tile);
+        fTiles[tile] = image;
+        if(image || !loadTmp) continue;
+        const auto loader = tiled->scheduleTileLoadFromTmpFile(tile);
+        if(loader) loader->addDependent(this);
+    }
 }
 
 void ImageRenderData::setupDirectDraw() {
@@ -47,6 +94,7 @@ void ImageRenderData::setupDirectDraw() {
     updateGlobalRect();
     fRenderTransform.reset();
     fRenderTransform.translate(fRelBoundingRect.x(), fRelBoundingRect.y());
+    fRenderTransform.scale(1/fImageScale, 1/fImageScale);
     fRenderTransform *= fScaledTransform;
     fRenderTransform.translate(-fGlobalRect.x(), -fGlobalRect.y());
     fUseRenderTransform = true;
@@ -58,22 +106,78 @@ void ImageRenderData::setupDirectDraw() {
 void ImageRenderData::drawSk(SkCanvas * const canvas) {
     const float x = static_cast<float>(fRelBoundingRect.x());
     const float y = static_cast<float>(fRelBoundingRect.y());
+    if(!isOne4Dec(fImageScale)) {
+        const float invScale = static_cast<float>(1/fImageScale);
+        canvas->translate(x, y);
+        canvas->scale(invScale, invScale);
+        canvas->translate(-x, -y);
+    }
+    if(fTiledImage) return drawTiles(canvas, x, y);
+    sk_sp<SkImage> image = fImage;
+    float dx = x;
+    float dy = y;
+    if(!image && fYuvImage) {
+        QPoint topLeft;
+        image = convertSampledYuv(canvas, topLeft);
+        dx += topLeft.x();
+        dy += topLeft.y();
+    }
+    if(!image) return;
     if(fFilterQuality > kNone_SkFilterQuality) {
         SkPaint paint;
         paint.setAntiAlias(true);
         paint.setFilterQuality(fFilterQuality);
-        canvas->drawImage(fImage, x, y, &paint);
-    } else if(fImage) canvas->drawImage(fImage, x, y);
+        canvas->drawImage(image, dx, dy, &paint);
+    } else canvas->drawImage(image, dx, dy);
+}
+
+void ImageRenderData::drawTiles(SkCanvas * const canvas,
+                                const float x, const float y) {
+    // no anti-aliasing, it would show the seams between the tiles
+    SkPaint paint;
+    paint.setFilterQuality(fFilterQuality);
+    QList<int> missing;
+    for(const auto& tile : fTiles) {
+        if(!tile.second) missing << tile.first;
+    }
+    for(const auto& decoded : fTiledImage->decodeTiles(missing)) {
+        fTiles[decoded.first] = decoded.second;
+        mDecodedTiles << decoded.first;
+    }
+    for(const auto& tile : fTiles) {
+        if(!tile.second) continue;
+        const auto pos = fTiledImage->tileRect(tile.first).topLeft();
+        canvas->drawImage(tile.second, x + pos.x(), y + pos.y(), &paint);
+    }
+}
+
+sk_sp<SkImage> ImageRenderData::convertSampledYuv(SkCanvas * const canvas,
+                                                  QPoint& topLeft) const {
+    // only the part of the frame that lands inside the bitmap is converted
+    QRect rect(0, 0, fYuvImage->width(), fYuvImage->height());
+    SkMatrix inverse;
+    if(canvas->getTotalMatrix().invert(&inverse)) {
+        const auto clip = SkRect::Make(canvas->getDeviceClipBounds());
+        auto sampled = inverse.mapRect(clip);
+        sampled.offset(-static_cast<float>(fRelBoundingRect.x()),
+                       -static_cast<float>(fRelBoundingRect.y()));
+        const auto bounds = sampled.roundOut();
+        // margin for the filtering of the edge pixels
+        rect = rect.intersected(QRect(bounds.left() - 2, bounds.top() - 2,
+                                      bounds.width() + 4, bounds.height() + 4));
+    }
+    return fYuvImage->toImage(rect, &topLeft);
 }
 
 void ImageContainerRenderData::setContainer(ImageCacheContainer *container) {
     if(!container) return;
     mSrcContainer = container;
-    fImage = container->requestImageCopy();
+    if(container->getYuvImage()) fYuvImage = container->getYuvImage();
+    else fImage = container->requestImageCopy();
 }
 
 void ImageContainerRenderData::afterProcessing() {
-    BoxRenderData::afterProcessing();
+    ImageRenderData::afterProcessing();
     if(mSrcContainer && fImage) {
         mSrcContainer->addImageCopy(fImage);
     }
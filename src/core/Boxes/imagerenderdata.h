@@ -27,6 +27,7 @@
 #define IMAGERENDERDATA_H
 #include "Boxes/boxrenderdata.h"
 #include "CacheHandlers/imagecachecontainer.h"
+#include "CacheHandlers/tiledimage.h"
 
 struct CORE_EXPORT ImageRenderData : public BoxRenderData {
     ImageRenderData(BoundingBox * const parentBoxT);
@@ -35,12 +36,31 @@ struct CORE_EXPORT ImageRenderData : public BoxRenderData {
 
     void updateRelBoundingRect();
     void setupRenderData() final;
+    void afterProcessing();
+
+    //! @brief Draws the tiles of tiled covering the rendered area,
+    //! loadTmp schedules loading of tiles spilled to a tmp file
+    void setTiledImage(const stdsptr<TiledImage>& tiled, const bool loadTmp);
 
     sk_sp<SkImage> fImage;
+    //! @brief Source kept as YUV, converted while drawing instead of fImage
+    stdsptr<YuvImage> fYuvImage;
+    //! @brief Size of fImage relative to the source, e.g., 0.5 for frames
+    //! decoded at half size
+    qreal fImageScale = 1;
+    //! @brief Source too large to be decoded whole
+    stdsptr<TiledImage> fTiledImage;
+    //! @brief Tiles of fTiledImage drawn, null ones get decoded in process
+    std::map<int, sk_sp<SkImage>> fTiles;
 private:
     void setupDirectDraw();
+    void drawTiles(SkCanvas * const canvas, const float x, const float y);
+    sk_sp<SkImage> convertSampledYuv(SkCanvas * const canvas,
+                                     QPoint& topLeft) const;
 
     void drawSk(SkCanvas * const canvas);
+
+    QList<int> mDecodedTiles;
 };
 
 struct CORE_EXPORT ImageContainerRenderData : public ImageRenderData {
@@ -52,6 +72,7 @@ public:
     void afterProcessing();
 private:
     using ImageRenderData::fImage;
+    using ImageRenderData::fYuvImage;
     stdptr<ImageCacheContainer> mSrcContainer;
 };
 
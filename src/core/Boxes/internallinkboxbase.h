@@ -41,6 +41,7 @@ public:
 
     FrameRange prp_getIdenticalRelRange(const int relFrame) const override;
     FrameRange prp_relInfluenceRange() const override;
+    quint64 renderStateKey(const qreal relFrame) const override;
     int prp_getRelFrameShift() const override;
 
     void writeBoundingBox(eWriteStream& dst) const override
@@ -227,6 +228,19 @@ FrameRange ILBB::prp_getIdenticalRelRange(const int relFrame) const {
     return range*targetRange;
 }
 
+template <typename BoxT>
+quint64 ILBB::renderStateKey(const qreal relFrame) const {
+    const quint64 own = BoxT::renderStateKey(relFrame);
+    const auto linkTarget = getLinkTarget();
+    if(!own || !linkTarget) return own;
+    const quint64 target = linkTarget->renderStateKey(relFrame);
+    if(!target) return 0;
+    const uint low = qHash(target, static_cast<uint>(own));
+    const uint high = qHash(target, static_cast<uint>(own >> 32));
+    const quint64 result = (static_cast<quint64>(high) << 32) | low;
+    return result ? result : 1;
+}
+
 template <typename BoxT>
 FrameRange ILBB::prp_relInfluenceRange() const {
     const auto linkTarget = getLinkTarget();
@@ -140,6 +140,21 @@ void VideoBox::changeSourceFile() {
     if(!path.isEmpty()) setFilePath(path);
 }
 
+void VideoBox::generateProxy() {
+    if(mFileHandler) mFileHandler->generateProxy();
+}
+
+void VideoBox::setupCanvasMenu(PropertyMenu * const menu) {
+    if(!menu->hasActionsForType<VideoBox>()) {
+        menu->addedActionsForType<VideoBox>();
+        const PropertyMenu::PlainSelectedOp<VideoBox> proxyOp =
+        [](VideoBox * box) { box->generateProxy(); };
+        menu->addPlainAction(QIcon::fromTheme("video"),
+                             tr("Generate Proxy"), proxyOp);
+    }
+    AnimationBox::setupCanvasMenu(menu);
+}
+
 void VideoBox::setStretch(const qreal stretch) {
     AnimationBox::setStretch(stretch);
     mSound->setStretch(stretch);
@@ -46,6 +46,9 @@ public:
         FrameRange range;
     };
     void changeSourceFile();
+    void generateProxy();
+
+    void setupCanvasMenu(PropertyMenu * const menu);
 
     void writeBoundingBox(eWriteStream& dst) const;
     void readBoundingBox(eReadStream& src);
@@ -57,6 +60,12 @@ public:
     void setFilePath(const QString& path);
     QString getFilePath();
     const VideoSpecs getSpecs();
+
+    //! @brief Decoded frames depend on proxies and decoder fallbacks
+    quint64 renderStateKey(const qreal relFrame) const {
+        Q_UNUSED(relFrame)
+        return 0;
+    }
 private:
     void setFilePathNoRename(const QString &path);
 
@@ -0,0 +1,130 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "effectresultcache.h"
+
+#include "smartPointers/ememory.h"
+
+#include <QHash>
+#include <QMutex>
+
+bool EffectResultKey::operator==(const EffectResultKey& other) const {
+    return fInput == other.fInput &&
+           fEffects == other.fEffects &&
+           fGlobalRect == other.fGlobalRect &&
+           qFuzzyCompare(fResolution, other.fResolution);
+}
+
+quint64 EffectResultKey::sHashState(const quint64 state,
+                                    const QMatrix& transform) {
+    uint low = static_cast<uint>(state);
+    uint high = static_cast<uint>(state >> 32);
+    for(const qreal value : {transform.m11(), transform.m12(),
+                             transform.m21(), transform.m22(),
+                             transform.dx(), transform.dy()}) {
+        low = qHash(value, low);
+        high = qHash(value, high);
+    }
+    const quint64 result = (static_cast<quint64>(high) << 32) | low;
+    return result ? result : 1;
+}
+
+quint64 EffectResultKey::sHashPixels(const sk_sp<SkImage>& img) {
+    if(!img) return 0;
+    SkPixmap pix;
+    if(!img->peekPixels(&pix)) return 0;
+    const int width = pix.width();
+    const int height = pix.height();
+    const size_t rowBytes = width*pix.info().bytesPerPixel();
+    uint low = qHash(width, qHash(height));
+    uint high = qHash(height, qHash(width, 1));
+    const auto bytes = static_cast<const uchar*>(pix.addr());
+    if(pix.rowBytes() == rowBytes) {
+        low = qHashBits(bytes, rowBytes*height, low);
+        high = qHashBits(bytes, rowBytes*height, high);
+    } else {
+        for(int y = 0; y < height; y++) {
+            const auto row = bytes + y*pix.rowBytes();
+            low = qHashBits(row, rowBytes, low);
+            high = qHashBits(row, rowBytes, high);
+        }
+    }
+    const quint64 result = (static_cast<quint64>(high) << 32) | low;
+    return result ? result : 1;
+}
+
+uint qHash(const EffectResultKey& key, const uint seed) {
+    uint result = qHash(key.fInput, seed);
+    result = qHash(key.fEffects, result);
+    result = qHash(key.fGlobalRect.x(), result);
+    result = qHash(key.fGlobalRect.y(), result);
+    result = qHash(key.fGlobalRect.width(), result);
+    return qHash(key.fGlobalRect.height(), result);
+}
+
+static QMutex sMutex;
+static QHash<EffectResultKey, stdsptr<EffectResultCacheContainer>> sResults;
+
+EffectResultCacheContainer::EffectResultCacheContainer(
+        const EffectResultKey& key, const sk_sp<SkImage>& img) :
+    mKey(key), mImage(img) {}
+
+int EffectResultCacheContainer::getByteCount() {
+    if(!mImage) return 0;
+    return mImage->width()*mImage->height()*
+           mImage->imageInfo().bytesPerPixel();
+}
+
+void EffectResultCacheContainer::noDataLeft_k() {
+    EffectResultCache::sRemove(mKey);
+}
+
+sk_sp<SkImage> EffectResultCache::sLookup(const EffectResultKey& key) {
+    if(!key.isValid()) return nullptr;
+    QMutexLocker lock(&sMutex);
+    const auto it = sResults.constFind(key);
+    if(it == sResults.constEnd()) return nullptr;
+    return it.value()->getImage();
+}
+
+void EffectResultCache::sStore(const EffectResultKey& key,
+                               const sk_sp<SkImage>& img) {
+    if(!key.isValid() || !img || img->isTextureBacked()) return;
+    const auto cont = enve::make_shared<EffectResultCacheContainer>(key, img);
+    QMutexLocker lock(&sMutex);
+    sResults.insert(key, cont);
+}
+
+void EffectResultCache::sTouch(const EffectResultKey& key) {
+    stdsptr<EffectResultCacheContainer> cont;
+    {
+        QMutexLocker lock(&sMutex);
+        cont = sResults.value(key);
+    }
+    if(cont) cont->updateInMemoryManagment();
+}
+
+void EffectResultCache::sRemove(const EffectResultKey& key) {
+    QMutexLocker lock(&sMutex);
+    sResults.remove(key);
+}
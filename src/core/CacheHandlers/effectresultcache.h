@@ -0,0 +1,79 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef EFFECTRESULTCACHE_H
+#define EFFECTRESULTCACHE_H
+#include "skia/skiaincludes.h"
+#include "cachecontainer.h"
+
+#include <QMatrix>
+#include <QRect>
+
+//! @brief Identifies the output of a raster effect chain, i.e.,
+//! hash of the input state or pixels, effect parameters and output geometry.
+struct CORE_EXPORT EffectResultKey {
+    quint64 fInput = 0;
+    quint64 fEffects = 0;
+    QRect fGlobalRect;
+    qreal fResolution = 1;
+
+    bool operator==(const EffectResultKey& other) const;
+    bool isValid() const { return fInput != 0; }
+
+    static quint64 sHashState(const quint64 state, const QMatrix& transform);
+    static quint64 sHashPixels(const sk_sp<SkImage>& img);
+};
+
+CORE_EXPORT uint qHash(const EffectResultKey& key, const uint seed = 0);
+
+class CORE_EXPORT EffectResultCacheContainer : public CacheContainer {
+    e_OBJECT
+protected:
+    EffectResultCacheContainer(const EffectResultKey& key,
+                               const sk_sp<SkImage>& img);
+public:
+    int getByteCount();
+
+    const sk_sp<SkImage>& getImage() const { return mImage; }
+protected:
+    void noDataLeft_k();
+private:
+    const EffectResultKey mKey;
+    const sk_sp<SkImage> mImage;
+};
+
+//! @brief Keeps post-effect images of boxes, so unchanged content
+//! does not have to go through the effect chain again.
+//! Lookups are thread-safe, store() and touch() are main-thread only.
+class CORE_EXPORT EffectResultCache {
+    friend class EffectResultCacheContainer;
+public:
+    static sk_sp<SkImage> sLookup(const EffectResultKey& key);
+    static void sStore(const EffectResultKey& key,
+                       const sk_sp<SkImage>& img);
+    static void sTouch(const EffectResultKey& key);
+private:
+    static void sRemove(const EffectResultKey& key);
+};
+
+#endif // EFFECTRESULTCACHE_H
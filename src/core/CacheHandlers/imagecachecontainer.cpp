@@ -39,13 +39,35 @@ ImageCacheContainer::ImageCacheContainer(const sk_sp<SkImage> &img,
     replaceImage(img);
 }
 
+ImageCacheContainer::ImageCacheContainer(const stdsptr<YuvImage> &yuv,
+                                         const FrameRange &range,
+                                         HddCachableCacheHandler * const parent) :
+    ImageCacheContainer(range, parent) {
+    replaceYuvImage(yuv);
+}
+
 void ImageCacheContainer::replaceImage(const sk_sp<SkImage> &img) {
     ImageDataHandler::replaceImage(img);
+    mYuvImage.reset();
+    mStoresYuv = false;
     afterDataReplaced();
 }
 
+void ImageCacheContainer::replaceYuvImage(const stdsptr<YuvImage> &yuv) {
+    ImageDataHandler::replaceImage(nullptr);
+    mYuvImage = yuv;
+    mStoresYuv = true;
+    afterDataReplaced();
+}
+
+sk_sp<SkImage> ImageCacheContainer::getRgbaImage() const {
+    if(mYuvImage) return mYuvImage->toImage();
+    return getImage();
+}
+
 int ImageCacheContainer::getByteCount() {
-    return getImageByteCount();
+    const int yuvBytes = mYuvImage ? mYuvImage->byteCount() : 0;
+    return getImageByteCount() + yuvBytes;
 }
 
 void ImageCacheContainer::setDataLoadedFromTmpFile(const sk_sp<SkImage> &img) {
@@ -53,15 +75,29 @@ void ImageCacheContainer::setDataLoadedFromTmpFile(const sk_sp<SkImage> &img) {
     afterDataLoadedFromTmpFile();
 }
 
+void ImageCacheContainer::setDataLoadedFromTmpFile(const stdsptr<YuvImage> &yuv) {
+    replaceYuvImage(yuv);
+    afterDataLoadedFromTmpFile();
+}
+
 int ImageCacheContainer::clearMemory() {
-    return ImageDataHandler::clearImageMemory();
+    const int yuvBytes = mYuvImage ? mYuvImage->byteCount() : 0;
+    mYuvImage.reset();
+    return ImageDataHandler::clearImageMemory() + yuvBytes;
 }
 
 stdsptr<eHddTask> ImageCacheContainer::createTmpFileDataSaver() {
+    if(mStoresYuv) return enve::make_shared<YuvSaver>(this, mYuvImage);
     return enve::make_shared<ImgSaver>(this, getImage());
 }
 
 stdsptr<eHddTask> ImageCacheContainer::createTmpFileDataLoader() {
+    if(mStoresYuv) {
+        const YuvLoader::Func func = [this](const stdsptr<YuvImage>& yuv) {
+            setDataLoadedFromTmpFile(yuv);
+        };
+        return enve::make_shared<YuvLoader>(mTmpFile, this, func);
+    }
     const ImgLoader::Func func = [this](sk_sp<SkImage> img) {
         setDataLoadedFromTmpFile(img);
     };
@@ -29,6 +29,7 @@
 #include "skia/skiahelpers.h"
 #include "hddcachablerangecont.h"
 #include "imagedatahandler.h"
+#include "yuvimage.h"
 class Canvas;
 
 class CORE_EXPORT ImageCacheContainer : public HddCachableRangeCont,
@@ -40,6 +41,9 @@ protected:
     ImageCacheContainer(const sk_sp<SkImage>& img,
                         const FrameRange &range,
                         HddCachableCacheHandler * const parent);
+    ImageCacheContainer(const stdsptr<YuvImage>& yuv,
+                        const FrameRange &range,
+                        HddCachableCacheHandler * const parent);
     stdsptr<eHddTask> createTmpFileDataSaver();
     stdsptr<eHddTask> createTmpFileDataLoader();
     int clearMemory();
@@ -47,13 +51,58 @@ public:
     int getByteCount();
 
     void setDataLoadedFromTmpFile(const sk_sp<SkImage> &img);
+    void setDataLoadedFromTmpFile(const stdsptr<YuvImage> &yuv);
     void replaceImage(const sk_sp<SkImage> &img);
+    void replaceYuvImage(const stdsptr<YuvImage> &yuv);
+
+    //! @brief Set when the data is kept as YUV rather than RGBA
+    const stdsptr<YuvImage>& getYuvImage() const { return mYuvImage; }
+    //! @brief RGBA image, converted from YUV data if stored as such
+    sk_sp<SkImage> getRgbaImage() const;
+private:
+    stdsptr<YuvImage> mYuvImage;
+    bool mStoresYuv = false;
 };
 
 
 #include "CacheHandlers/tmploader.h"
 #include "CacheHandlers/tmpsaver.h"
 
+class CORE_EXPORT YuvSaver : public TmpSaver {
+    e_OBJECT
+protected:
+    YuvSaver(ImageCacheContainer* const target,
+             const stdsptr<YuvImage> &yuv) :
+        TmpSaver(target), mYuv(yuv) {}
+
+    void write(eWriteStream& dst) {
+        mYuv->write(dst);
+    }
+private:
+    const stdsptr<YuvImage> mYuv;
+};
+
+class CORE_EXPORT YuvLoader : public TmpLoader {
+    e_OBJECT
+public:
+    typedef std::function<void(const stdsptr<YuvImage>& yuv)> Func;
+protected:
+    YuvLoader(const qsptr<QTemporaryFile> &file,
+              ImageCacheContainer* const target,
+              const Func& finishedFunc) :
+        TmpLoader(file, target), mFinishedFunc(finishedFunc) {}
+
+    void read(eReadStream& src) {
+        mYuv = YuvImage::sRead(src);
+    }
+    void afterProcessing() {
+        if(mFinishedFunc) mFinishedFunc(mYuv);
+    }
+private:
+    stdsptr<YuvImage> mYuv;
+    const Func mFinishedFunc;
+};
+
 class CORE_EXPORT ImgSaver : public TmpSaver {
     e_OBJECT
 public:
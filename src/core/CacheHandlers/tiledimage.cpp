@@ -0,0 +1,178 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "tiledimage.h"
+
+#include "include/codec/SkAndroidCodec.h"
+
+class TiledImage::TileContainer : public ImageCacheContainer {
+    e_OBJECT
+protected:
+    TileContainer(const sk_sp<SkImage>& img) :
+        ImageCacheContainer(img, FrameRange::EMINMAX, nullptr) {}
+
+    int clearMemory() {
+        // reading a tile back is cheaper than decoding it again
+        if(!getTmpFile()) scheduleSaveToTmpFile();
+        return ImageCacheContainer::clearMemory();
+    }
+};
+
+TiledImage::TiledImage(const sk_sp<SkData>& data, const int sampleSize,
+                       const QSize& size) :
+    mData(data), mSampleSize(sampleSize), mSize(size) {}
+
+bool TiledImage::sShouldTile(const QSize& size) {
+    return qint64(size.width())*size.height() > 4096*4096;
+}
+
+int TiledImage::columns() const {
+    return (mSize.width() + sTileSize - 1)/sTileSize;
+}
+
+QRect TiledImage::tileRect(const int tile) const {
+    const int cols = columns();
+    const QRect rect((tile % cols)*sTileSize, (tile/cols)*sTileSize,
+                     sTileSize, sTileSize);
+    return rect.intersected(QRect(QPoint(0, 0), mSize));
+}
+
+QList<int> TiledImage::tilesIn(const QRect& rect) const {
+    QList<int> result;
+    const QRect bounded = rect.intersected(QRect(QPoint(0, 0), mSize));
+    if(bounded.isEmpty()) return result;
+    const int cols = columns();
+    for(int row = bounded.top()/sTileSize;
+        row <= bounded.bottom()/sTileSize; row++) {
+        for(int col = bounded.left()/sTileSize;
+            col <= bounded.right()/sTileSize; col++) {
+            result << row*cols + col;
+        }
+    }
+    return result;
+}
+
+sk_sp<SkImage> TiledImage::getTile(const int tile) const {
+    const auto it = mTiles.find(tile);
+    if(it == mTiles.end()) return nullptr;
+    const auto& cont = it->second;
+    if(!cont->storesDataInMemory()) return nullptr;
+    return cont->getImage();
+}
+
+eTask* TiledImage::scheduleTileLoadFromTmpFile(const int tile) {
+    const auto it = mTiles.find(tile);
+    if(it == mTiles.end()) return nullptr;
+    return it->second->scheduleLoadFromTmpFile();
+}
+
+void TiledImage::setTile(const int tile, const sk_sp<SkImage>& img) {
+    if(!img) return;
+    auto& cont = mTiles[tile];
+    if(cont) cont->replaceImage(img);
+    else cont = enve::make_shared<TileContainer>(img);
+}
+
+sk_sp<SkImage> TiledImage::decodeRect(SkAndroidCodec& codec,
+                                      const QRect& rect) const {
+    const auto full = SkIRect::MakeSize(codec.getInfo().dimensions());
+    const auto wanted = SkIRect::MakeXYWH(rect.x()*mSampleSize,
+                                          rect.y()*mSampleSize,
+                                          rect.width()*mSampleSize,
+                                          rect.height()*mSampleSize);
+    SkIRect subset = wanted;
+    if(!subset.intersect(full)) return nullptr;
+    const bool whole = subset == full;
+    // the codec may move the subset to its block boundaries
+    if(!whole && !codec.getSupportedSubset(&subset)) return nullptr;
+    const auto dims = whole ? codec.getSampledDimensions(mSampleSize) :
+                              codec.getSampledSubsetDimensions(mSampleSize, subset);
+    const auto alphaType = codec.computeOutputAlphaType(false);
+    const auto info = SkImageInfo::MakeN32(dims.width(), dims.height(),
+                                           alphaType);
+    SkBitmap bitmap;
+    if(!bitmap.tryAllocPixels(info)) return nullptr;
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = mSampleSize;
+    options.fSubset = whole ? nullptr : &subset;
+    const auto result = codec.getAndroidPixels(info, bitmap.getPixels(),
+                                               bitmap.rowBytes(), &options);
+    if(result != SkCodec::kSuccess &&
+       result != SkCodec::kIncompleteInput) return nullptr;
+    bitmap.setImmutable();
+    const auto image = SkImage::MakeFromBitmap(bitmap);
+    if(subset == wanted) return image;
+    const int dx = (wanted.left() - subset.left())/mSampleSize;
+    const int dy = (wanted.top() - subset.top())/mSampleSize;
+    auto crop = SkIRect::MakeXYWH(dx, dy, rect.width(), rect.height());
+    if(!crop.intersect(image->bounds())) return nullptr;
+    return image->makeSubset(crop);
+}
+
+std::map<int, sk_sp<SkImage>> TiledImage::decodeTiles(const QList<int>& tiles) const {
+    std::map<int, sk_sp<SkImage>> result;
+    if(tiles.isEmpty()) return result;
+    const auto codec = SkAndroidCodec::MakeFromData(mData);
+    if(!codec) return result;
+
+    const int cols = columns();
+    QRect span;
+    for(const int tile : tiles) span |= QRect(tile % cols, tile/cols, 1, 1);
+    // codecs scan from the top for every decode (e.g., JPEG), decode
+    // as many rows at once as the band budget allows
+    const qint64 rowPixels = qint64(span.width())*sTileSize*sTileSize;
+    const int bandRows = int(qBound(qint64(1), sMaxBandPixels/rowPixels,
+                                    qint64(span.height())));
+    const auto cutTiles = [&](const sk_sp<SkImage>& band, const QRect& bandRect) {
+        for(const int tile : tiles) {
+            const QRect rect = tileRect(tile);
+            if(result.count(tile) || !bandRect.contains(rect)) continue;
+            const QRect rel = rect.translated(-bandRect.topLeft());
+            const auto crop = SkIRect::MakeXYWH(rel.x(), rel.y(),
+                                                rel.width(), rel.height());
+            if(!band->bounds().contains(crop)) continue;
+            result[tile] = band->makeSubset(crop);
+        }
+    };
+    for(int row = span.top(); row <= span.bottom(); row += bandRows) {
+        const int rows = qMin(bandRows, span.bottom() - row + 1);
+        const QRect bandRect = QRect(span.left()*sTileSize, row*sTileSize,
+                                     span.width()*sTileSize, rows*sTileSize).
+                intersected(QRect(QPoint(0, 0), mSize));
+        const auto band = decodeRect(*codec, bandRect);
+        if(band) cutTiles(band, bandRect);
+    }
+    // codecs without subset decoding, cut from the whole image instead
+    if(result.size() < size_t(tiles.count())) {
+        const QRect wholeRect(QPoint(0, 0), mSize);
+        const auto whole = decodeRect(*codec, wholeRect);
+        if(whole) cutTiles(whole, wholeRect);
+    }
+    return result;
+}
+
+sk_sp<SkImage> TiledImage::decodeWhole() const {
+    const auto codec = SkAndroidCodec::MakeFromData(mData);
+    if(!codec) return nullptr;
+    return decodeRect(*codec, QRect(QPoint(0, 0), mSize));
+}
@@ -0,0 +1,79 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include "imagecachecontainer.h"
+
+#include <map>
+
+class eTask;
+class SkAndroidCodec;
+
+//! @brief Image too large to be kept whole, split into a grid of tiles
+//! decoded on demand from the encoded file. Tiles are freed individually
+//! by the memory handler and spill to a tmp file when freed.
+class CORE_EXPORT TiledImage {
+public:
+    //! @brief data is the encoded file, decoded at 1/sampleSize to size
+    TiledImage(const sk_sp<SkData>& data, const int sampleSize,
+               const QSize& size);
+
+    static const int sTileSize = 512;
+
+    //! @brief True if an image of size is better kept as tiles
+    static bool sShouldTile(const QSize& size);
+
+    const QSize& size() const { return mSize; }
+    QRect tileRect(const int tile) const;
+    //! @brief Indices of the tiles intersecting rect
+    QList<int> tilesIn(const QRect& rect) const;
+
+    //! @brief Tile kept in memory, nullptr otherwise
+    sk_sp<SkImage> getTile(const int tile) const;
+    eTask* scheduleTileLoadFromTmpFile(const int tile);
+    void setTile(const int tile, const sk_sp<SkImage>& img);
+
+    //! @brief Decodes tiles from the encoded file, safe on any thread.
+    //! Rows of tiles are decoded together in bands of up to sMaxBandPixels,
+    //! tiles the codec cannot decode as a subset come from a whole decode.
+    std::map<int, sk_sp<SkImage>> decodeTiles(const QList<int>& tiles) const;
+    //! @brief Decodes the whole image, e.g. for export, nullptr on failure
+    sk_sp<SkImage> decodeWhole() const;
+private:
+    class TileContainer;
+
+    static const qint64 sMaxBandPixels = 4096*4096;
+
+    int columns() const;
+    //! @brief Decodes rect of this level, nullptr on failure
+    sk_sp<SkImage> decodeRect(SkAndroidCodec& codec, const QRect& rect) const;
+
+    const sk_sp<SkData> mData;
+    const int mSampleSize;
+    const QSize mSize;
+    std::map<int, stdsptr<TileContainer>> mTiles;
+};
+
+#endif // TILEDIMAGE_H
@@ -0,0 +1,160 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "yuvimage.h"
+#include "skia/skiahelpers.h"
+#include "swscontextcache.h"
+
+extern "C" {
+    #include <libavutil/imgutils.h>
+    #include <libavutil/pixdesc.h>
+}
+
+YuvImage::YuvImage(const int width, const int height, const bool fullRange) :
+    mWidth(width), mHeight(height), mFullRange(fullRange) {
+    const int lumaBytes = width*height;
+    const int chromaBytes = chromaWidth()*chromaHeight();
+    mData.resize(lumaBytes + 2*chromaBytes);
+}
+
+void YuvImage::planes(uint8_t* data[4], int linesize[4]) {
+    const auto luma = reinterpret_cast<uint8_t*>(mData.data());
+    const int chromaBytes = chromaWidth()*chromaHeight();
+    data[0] = luma;
+    data[1] = luma + mWidth*mHeight;
+    data[2] = data[1] + chromaBytes;
+    data[3] = nullptr;
+    linesize[0] = mWidth;
+    linesize[1] = chromaWidth();
+    linesize[2] = chromaWidth();
+    linesize[3] = 0;
+}
+
+static bool isFullRange(const AVPixelFormat format) {
+    switch(format) {
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_YUVJ422P:
+    case AV_PIX_FMT_YUVJ444P:
+    case AV_PIX_FMT_YUVJ440P:
+    case AV_PIX_FMT_YUVJ411P:
+        return true;
+    default:
+        return false;
+    }
+}
+
+stdsptr<YuvImage> YuvImage::sFromFrame(const AVFrame * const frame,
+                                       const int width, const int height,
+                                       const int swsFlags) {
+    const auto format = static_cast<AVPixelFormat>(frame->format);
+    const auto desc = av_pix_fmt_desc_get(format);
+    if(!desc || desc->nb_components < 3) return nullptr;
+    const auto excluded = AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_ALPHA |
+                          AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL;
+    if(desc->flags & excluded) return nullptr;
+    // only 8-bit 4:2:0 is stored without loss, other sources
+    // (4:2:2, 4:4:4, higher bit depths) keep the RGBA path
+    if(desc->log2_chroma_w != 1 || desc->log2_chroma_h != 1) return nullptr;
+    for(int i = 0; i < desc->nb_components; i++) {
+        if(desc->comp[i].depth != 8) return nullptr;
+    }
+
+    const bool fullRange = isFullRange(format);
+    const auto dstFormat = fullRange ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+    const auto result = stdsptr<YuvImage>(new YuvImage(width, height,
+                                                       fullRange));
+    uint8_t* dstData[4];
+    int dstLinesize[4];
+    result->planes(dstData, dstLinesize);
+    if(format == dstFormat && width == frame->width &&
+       height == frame->height) {
+        av_image_copy(dstData, dstLinesize,
+                      const_cast<const uint8_t**>(frame->data),
+                      frame->linesize, format, width, height);
+        return result;
+    }
+    const SwsContextCache::Conversion conv{format, frame->width, frame->height,
+                                           dstFormat, width, height,
+                                           swsFlags};
+    const bool scaled = SwsContextCache::sScale(
+                conv, frame->data, frame->linesize, dstData, dstLinesize);
+    if(!scaled) return nullptr;
+    return result;
+}
+
+stdsptr<YuvImage> YuvImage::sRead(eReadStream& src) {
+    int width, height;
+    bool fullRange;
+    src >> width >> height >> fullRange;
+    const auto result = stdsptr<YuvImage>(new YuvImage(width, height,
+                                                       fullRange));
+    src >> result->mData;
+    return result;
+}
+
+void YuvImage::write(eWriteStream& dst) const {
+    dst << mWidth << mHeight << mFullRange;
+    dst << mData;
+}
+
+sk_sp<SkImage> YuvImage::toImage() const {
+    return toImage(QRect(0, 0, mWidth, mHeight), nullptr);
+}
+
+sk_sp<SkImage> YuvImage::toImage(const QRect& rect,
+                                 QPoint * const topLeft) const {
+    const int x0 = qMax(0, rect.left()) & ~1;
+    const int y0 = qMax(0, rect.top()) & ~1;
+    const int x1 = qMin(mWidth, rect.x() + rect.width());
+    const int y1 = qMin(mHeight, rect.y() + rect.height());
+    if(x1 <= x0 || y1 <= y0) return nullptr;
+    const int width = x1 - x0;
+    const int height = y1 - y0;
+    if(topLeft) *topLeft = QPoint(x0, y0);
+
+    uint8_t* data[4];
+    int linesize[4];
+    const_cast<YuvImage*>(this)->planes(data, linesize);
+    const uint8_t* const srcData[4] = {
+        data[0] + y0*linesize[0] + x0,
+        data[1] + (y0/2)*linesize[1] + x0/2,
+        data[2] + (y0/2)*linesize[2] + x0/2,
+        nullptr
+    };
+
+    const auto format = mFullRange ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+    const SwsContextCache::Conversion conv{format, width, height,
+                                           AV_PIX_FMT_RGBA, width, height,
+                                           SWS_BICUBIC};
+
+    const auto info = SkiaHelpers::getPremulRGBAInfo(width, height);
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    uint8_t * const dstData[] = { static_cast<uint8_t*>(bitmap.getPixels()) };
+    const int dstLinesize[] = { static_cast<int>(bitmap.rowBytes()) };
+
+    if(!SwsContextCache::sScale(conv, srcData, linesize,
+                                dstData, dstLinesize)) return nullptr;
+
+    return SkiaHelpers::transferDataToSkImage(bitmap);
+}
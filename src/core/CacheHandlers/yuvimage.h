@@ -0,0 +1,72 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef YUVIMAGE_H
+#define YUVIMAGE_H
+
+#include "skia/skiaincludes.h"
+#include "smartPointers/stdselfref.h"
+#include "ReadWrite/ewritestream.h"
+#include "ReadWrite/ereadstream.h"
+
+#include <QRect>
+
+extern "C" {
+    #include <libavutil/frame.h>
+}
+
+//! @brief Compact planar 8-bit 4:2:0 picture, i.e., 1.5 bytes per pixel,
+//! converted to RGBA only for the part that gets drawn.
+class CORE_EXPORT YuvImage {
+public:
+    //! @brief Copies frame scaled to width x height, nullptr for
+    //! formats other than 8-bit 4:2:0 YUV, which would lose quality
+    static stdsptr<YuvImage> sFromFrame(const AVFrame * const frame,
+                                        const int width, const int height,
+                                        const int swsFlags);
+    static stdsptr<YuvImage> sRead(eReadStream& src);
+    void write(eWriteStream& dst) const;
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+    int byteCount() const { return mData.size(); }
+
+    //! @brief Converts rect, moved to even coordinates for the chroma
+    //! planes, to premultiplied RGBA, topLeft is set to its actual origin
+    sk_sp<SkImage> toImage(const QRect& rect, QPoint * const topLeft) const;
+    sk_sp<SkImage> toImage() const;
+private:
+    YuvImage(const int width, const int height, const bool fullRange);
+
+    int chromaWidth() const { return (mWidth + 1)/2; }
+    int chromaHeight() const { return (mHeight + 1)/2; }
+    void planes(uint8_t* data[4], int linesize[4]);
+
+    const int mWidth;
+    const int mHeight;
+    //! @brief JPEG (0-255) rather than MPEG (16-235) range
+    const bool mFullRange;
+    QByteArray mData;
+};
+
+#endif // YUVIMAGE_H
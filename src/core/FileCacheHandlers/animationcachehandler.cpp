@@ -35,6 +35,36 @@
 
 AnimationFrameHandler::AnimationFrameHandler() {}
 
+ImageCacheContainer* AnimationFrameHandler::getScaledFrameAtFrame(
+        const int relFrame, const int downscale) {
+    Q_UNUSED(downscale)
+    return getFrameAtFrame(relFrame);
+}
+
+ImageCacheContainer* AnimationFrameHandler::getScaledFrameAtOrBeforeFrame(
+        const int relFrame, const int downscale) {
+    Q_UNUSED(downscale)
+    return getFrameAtOrBeforeFrame(relFrame);
+}
+
+eTask* AnimationFrameHandler::scheduleScaledFrameLoad(const int frame,
+                                                      const int downscale) {
+    Q_UNUSED(downscale)
+    return scheduleFrameLoad(frame);
+}
+
+int AnimationFrameHandler::sDownscaleForScale(const qreal scale) {
+    int downscale = 1;
+    while(downscale < 8 && scale*downscale*2 <= 1) downscale *= 2;
+    return downscale;
+}
+
+int AnimationFrameHandler::sDownscaledSize(const int size,
+                                           const int downscale) {
+    if(downscale <= 1) return size;
+    return qMax(2, (size/downscale) & ~1);
+}
+
 class AnimationSaverSVG : public ComplexTask {
 public:
     AnimationSaverSVG(AnimationFrameHandler* const src,
@@ -93,13 +123,13 @@ private:
             task->addDependent({[ptr, relFrame, timeFrame, imageId]() {
                 if(!ptr) return;
                 const auto cont = ptr->mSrc->getFrameAtOrBeforeFrame(relFrame);
-                if(cont) ptr->saveSurfaceValues(timeFrame, cont->getImage(), imageId);
+                if(cont) ptr->saveSurfaceValues(timeFrame, cont->getRgbaImage(), imageId);
             }, nullptr});
             addTask(task->ref<eTask>());
             return true;
         } else {
             const auto cont = mSrc->getFrameAtOrBeforeFrame(relFrame);
-            if(cont) saveSurfaceValues(timeFrame, cont->getImage(), imageId);
+            if(cont) saveSurfaceValues(timeFrame, cont->getRgbaImage(), imageId);
             return false;
         }
     }
@@ -47,6 +47,28 @@ public:
     virtual int getFrameCount() const = 0;
     virtual void reload() = 0;
 
+    //! @brief Frames reduced by downscale (1, 2, 4 or 8) along each axis,
+    //! handlers without reduced size decoding return full size frames.
+    virtual ImageCacheContainer* getScaledFrameAtFrame(
+            const int relFrame, const int downscale);
+    virtual ImageCacheContainer* getScaledFrameAtOrBeforeFrame(
+            const int relFrame, const int downscale);
+    virtual eTask* scheduleScaledFrameLoad(const int frame,
+                                           const int downscale);
+    //! @brief Downscale of the frames provided for the requested one,
+    //! e.g., proxies might provide smaller frames for preview
+    virtual int frameDownscale(const int downscale, const bool preview) const {
+        Q_UNUSED(downscale)
+        Q_UNUSED(preview)
+        return 1;
+    }
+
+    //! @brief Largest supported downscale still providing the given scale
+    static int sDownscaleForScale(const qreal scale);
+    //! @brief Width or height of frames reduced by downscale, even when
+    //! reduced, shared by reduced size decoding and proxies
+    static int sDownscaledSize(const int size, const int downscale);
+
     eTaskBase* saveAnimationSVG(SvgExporter& exp, QDomElement& parent,
                                 const FrameRange& relRange,
                                 const FrameRange& visRelRange);
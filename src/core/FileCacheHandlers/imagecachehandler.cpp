@@ -30,6 +30,9 @@
 
 #include "GUI/edialogs.h"
 #include "filesourcescache.h"
+#include "Private/Tasks/taskexecutor.h"
+
+#include "include/codec/SkAndroidCodec.h"
 
 ImageFileDataHandler::ImageFileDataHandler() {}
 
@@ -45,70 +48,172 @@ void ImageFileDataHandler::afterSourceChanged()
 }
 
 void ImageFileDataHandler::clearCache() {
-    mImage.reset();
-    mImageLoader.reset();
+    mMips.clear();
 }
 
-eTask *ImageFileDataHandler::scheduleLoad()
+eTask *ImageFileDataHandler::scheduleScaledLoad(const int downscale,
+                                                const bool allowTiles)
 {
-    if (mImage) {
-        const auto task = mImage->scheduleLoadFromTmpFile();
+    auto& level = mMips[downscale];
+    if (level.fImage) {
+        const auto task = level.fImage->scheduleLoadFromTmpFile();
         if (task) { return task; }
     }
-    if (mImageLoader) { return mImageLoader.get(); }
+    if (level.fLoader) { return level.fLoader.get(); }
     switch (mType) {
     /*case Type::ora:
-        mImageLoader = enve::make_shared<OraLoader>(mFilePath, this);
+        level.fLoader = enve::make_shared<OraLoader>(mFilePath, this);
         break;*/
     case Type::image:
-        mImageLoader = enve::make_shared<ImageLoader>(mFilePath, this);
+        level.fLoader = enve::make_shared<ImageLoader>(mFilePath, this,
+                                                       downscale, allowTiles);
         break;
     default:
         return nullptr;
     }
-    if (mImageLoader) { mImageLoader->queTask(); }
-    return mImageLoader.get();
+    if (level.fLoader) { level.fLoader->queTask(); }
+    return level.fLoader.get();
+}
+
+bool ImageFileDataHandler::hasScaledImage(const int downscale) const
+{
+    const auto it = mMips.find(downscale);
+    if (it == mMips.end()) { return false; }
+    if (it->second.fTiles) { return true; }
+    if (!it->second.fImage) { return false; }
+    return it->second.fImage->hasImage();
 }
 
-bool ImageFileDataHandler::hasImage() const
+int ImageFileDataHandler::loadedDownscale(const int downscale) const
 {
-    if (!mImage) { return false; }
-    return mImage->hasImage();
+    // a finer level already in memory is preferred over decoding again,
+    // unless tiled, as its tiles would still have to be decoded
+    for (int i = downscale; i >= 1; i /= 2) {
+        if (i != downscale && getScaledTiledImage(i)) { continue; }
+        if (hasScaledImage(i)) { return i; }
+    }
+    return 0;
 }
 
 sk_sp<SkImage> ImageFileDataHandler::getImage() const
 {
-    if (!mImage) { return nullptr; }
-    return mImage->getImage();
+    const auto it = mMips.find(1);
+    if (it == mMips.end() || !it->second.fImage) { return nullptr; }
+    return it->second.fImage->getImage();
+}
+
+ImageCacheContainer *ImageFileDataHandler::getScaledImageContainer(
+        const int downscale)
+{
+    const auto it = mMips.find(downscale);
+    if (it == mMips.end()) { return nullptr; }
+    return it->second.fImage.get();
+}
+
+stdsptr<TiledImage> ImageFileDataHandler::getScaledTiledImage(
+        const int downscale) const
+{
+    const auto it = mMips.find(downscale);
+    if (it == mMips.end()) { return nullptr; }
+    return it->second.fTiles;
 }
 
-void ImageFileDataHandler::replaceImage(const sk_sp<SkImage> &img)
+void ImageFileDataHandler::replaceImage(const sk_sp<SkImage> &img,
+                                        const int downscale)
 {
+    auto& level = mMips[downscale];
     if (img) {
-        mImage = enve::make_shared<ImageCacheContainerX>(img, this);
-    } else { mImage.reset(); }
-    mImageLoader.reset();
+        level.fImage = enve::make_shared<ImageCacheContainerX>(
+                    img, this, downscale);
+    } else { level.fImage.reset(); }
+    level.fTiles.reset();
+    level.fLoader.reset();
+}
+
+void ImageFileDataHandler::setTiledImage(const stdsptr<TiledImage> &tiles,
+                                         const int downscale)
+{
+    auto& level = mMips[downscale];
+    level.fImage.reset();
+    level.fTiles = tiles;
+    level.fLoader.reset();
+}
+
+// decodes at 1/sampleSize of the size, JPEG and WebP scale while decoding
+// so the full resolution image is never allocated
+static sk_sp<SkImage> decodeSampled(const sk_sp<SkData>& data,
+                                    const int sampleSize)
+{
+    const auto codec = SkAndroidCodec::MakeFromData(data);
+    if (!codec) { return nullptr; }
+    const auto dims = codec->getSampledDimensions(sampleSize);
+    const auto alphaType = codec->computeOutputAlphaType(false);
+    const auto info = SkImageInfo::MakeN32(dims.width(), dims.height(),
+                                           alphaType);
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(info)) { return nullptr; }
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    const auto result = codec->getAndroidPixels(info, bitmap.getPixels(),
+                                                bitmap.rowBytes(), &options);
+    if (result != SkCodec::kSuccess &&
+        result != SkCodec::kIncompleteInput) { return nullptr; }
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
 }
 
 ImageLoader::ImageLoader(const QString &filePath,
-                         ImageFileDataHandler * const handler)
+                         ImageFileDataHandler * const handler,
+                         const int downscale,
+                         const bool allowTiles)
     : mTargetHandler(handler)
-    , mFilePath(filePath) {}
+    , mFilePath(filePath)
+    , mDownscale(downscale)
+    , mAllowTiles(allowTiles) {}
 
 void ImageLoader::process()
 {
-    const sk_sp<SkData> data = SkData::MakeFromFileName(mFilePath.toUtf8().data());
-    mImage = SkImage::MakeFromEncoded(data);
+    if (!mData) {
+        mData = SkData::MakeFromFileName(mFilePath.toUtf8().data());
+        return;
+    }
+    if (mAllowTiles) {
+        const auto codec = SkAndroidCodec::MakeFromData(mData);
+        const auto dims = codec ? codec->getSampledDimensions(mDownscale) :
+                                  SkISize::MakeEmpty();
+        const QSize size(dims.width(), dims.height());
+        if (TiledImage::sShouldTile(size)) {
+            // tiles decode from the memory mapped file when drawn
+            mTiledImage = std::make_shared<TiledImage>(mData, mDownscale,
+                                                       size);
+            mData.reset();
+            return;
+        }
+    }
+    mImage = decodeSampled(mData, mDownscale);
+    mData.reset();
+}
+
+bool ImageLoader::nextStep()
+{
+    if (mData) {
+        CpuTaskExecutor::sAddTask(ref<eTask>());
+        return true;
+    }
+    return false;
 }
 
 void ImageLoader::afterProcessing()
 {
-    if (mTargetHandler) { mTargetHandler->replaceImage(mImage); }
+    if (!mTargetHandler) { return; }
+    if (mTiledImage) {
+        mTargetHandler->setTiledImage(mTiledImage, mDownscale);
+    } else { mTargetHandler->replaceImage(mImage, mDownscale); }
 }
 
 void ImageLoader::afterCanceled()
 {
-    if (mTargetHandler) { mTargetHandler->replaceImage(mImage); }
+    if (mTargetHandler) { mTargetHandler->replaceImage(mImage, mDownscale); }
 }
 
 /*void OraLoader::process()
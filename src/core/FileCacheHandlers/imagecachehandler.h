@@ -25,11 +25,13 @@
 
 #ifndef IMAGECACHEHANDLER_H
 #define IMAGECACHEHANDLER_H
+#include <map>
 #include "skia/skiahelpers.h"
 #include "filecachehandler.h"
 #include "Tasks/updatable.h"
 #include "CacheHandlers/usepointer.h"
 #include "CacheHandlers/imagecachecontainer.h"
+#include "CacheHandlers/tiledimage.h"
 class ImageFileDataHandler;
 
 class CORE_EXPORT ImageLoader : public eHddTask
@@ -38,17 +40,25 @@ class CORE_EXPORT ImageLoader : public eHddTask
 
 protected:
     ImageLoader(const QString &filePath,
-                ImageFileDataHandler * const handler);
+                ImageFileDataHandler * const handler,
+                const int downscale = 1,
+                const bool allowTiles = false);
 
 public:
     void process();
+    bool nextStep();
     void afterProcessing();
     void afterCanceled();
 
 protected:
     const qptr<ImageFileDataHandler> mTargetHandler;
     const QString mFilePath;
+    const int mDownscale;
+    const bool mAllowTiles;
+    //! @brief Encoded file read on the hdd thread, decoded on a cpu thread
+    sk_sp<SkData> mData;
     sk_sp<SkImage> mImage;
+    stdsptr<TiledImage> mTiledImage;
 };
 
 /*class CORE_EXPORT OraLoader : public ImageLoader
@@ -76,19 +86,28 @@ class CORE_EXPORT ImageFileDataHandler : public FileDataCacheHandler
         e_OBJECT
     protected:
         ImageCacheContainerX(const sk_sp<SkImage> &img,
-                             ImageFileDataHandler* const handler)
+                             ImageFileDataHandler* const handler,
+                             const int downscale)
         : ImageCacheContainer(img, FrameRange::EMINMAX, nullptr)
-        , mHandler(handler) {}
+        , mHandler(handler)
+        , mDownscale(downscale) {}
 
         void noDataLeft_k()
         {
             ImageCacheContainer::noDataLeft_k();
             if (!mHandler) { return; }
-            mHandler->mImage.reset();
+            mHandler->mMips[mDownscale].fImage.reset();
         }
 
     private:
         const qptr<ImageFileDataHandler> mHandler;
+        const int mDownscale;
+    };
+
+    struct MipLevel {
+        stdsptr<ImageCacheContainerX> fImage;
+        stdsptr<TiledImage> fTiles;
+        stdsptr<ImageLoader> fLoader;
     };
 
 protected:
@@ -98,18 +117,30 @@ public:
     void afterSourceChanged();
     void clearCache();
 
-    eTask *scheduleLoad();
+    eTask *scheduleLoad() { return scheduleScaledLoad(1); }
+    //! @brief Loads the image decoded at 1/downscale of its size,
+    //! allowTiles lets a huge image be kept as a TiledImage instead
+    eTask *scheduleScaledLoad(const int downscale,
+                              const bool allowTiles = false);
 
-    bool hasImage() const;
+    bool hasImage() const { return hasScaledImage(1); }
+    bool hasScaledImage(const int downscale) const;
+    //! @brief Largest loaded downscale not above downscale, 0 if none
+    int loadedDownscale(const int downscale) const;
     sk_sp<SkImage> getImage() const;
-    ImageCacheContainer* getImageContainer() { return mImage.get(); }
+    ImageCacheContainer* getImageContainer()
+    { return getScaledImageContainer(1); }
+    ImageCacheContainer* getScaledImageContainer(const int downscale);
+    stdsptr<TiledImage> getScaledTiledImage(const int downscale) const;
 
 private:
-    void replaceImage(const sk_sp<SkImage> &img);
+    void replaceImage(const sk_sp<SkImage> &img, const int downscale);
+    void setTiledImage(const stdsptr<TiledImage> &tiles,
+                       const int downscale);
 
-    stdsptr<ImageCacheContainerX> mImage;
+    //! @brief Mip pyramid keyed by downscale, i.e., 1, 2, 4 and 8
+    std::map<int, MipLevel> mMips;
     Type mType = Type::none;
-    stdsptr<ImageLoader> mImageLoader;
 };
 
 class CORE_EXPORT ImageFileHandler : public FileCacheHandler
@@ -135,6 +166,19 @@ public:
         return mDataHandler->scheduleLoad();
     }
 
+    eTask * scheduleScaledLoad(const int downscale,
+                               const bool allowTiles = false)
+    {
+        if (!mDataHandler) { return nullptr; }
+        return mDataHandler->scheduleScaledLoad(downscale, allowTiles);
+    }
+
+    int loadedDownscale(const int downscale) const
+    {
+        if (!mDataHandler) { return 0; }
+        return mDataHandler->loadedDownscale(downscale);
+    }
+
     bool hasImage() const
     {
         if (!mDataHandler) { return false; }
@@ -153,6 +197,18 @@ public:
         return mDataHandler->getImageContainer();
     }
 
+    ImageCacheContainer* getScaledImageContainer(const int downscale) const
+    {
+        if (!mDataHandler) { return nullptr; }
+        return mDataHandler->getScaledImageContainer(downscale);
+    }
+
+    stdsptr<TiledImage> getScaledTiledImage(const int downscale) const
+    {
+        if (!mDataHandler) { return nullptr; }
+        return mDataHandler->getScaledTiledImage(downscale);
+    }
+
 private:
     qsptr<ImageFileDataHandler> mDataHandler;
 };
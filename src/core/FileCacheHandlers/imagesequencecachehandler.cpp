@@ -29,9 +29,10 @@
 
 #include "filesourcescache.h"
 #include "fileshandler.h"
+#include "Private/esettings.h"
 
 ImageCacheContainer* ImageSequenceFileHandler::getFrameAtFrame(const int relFrame) {
-    if(mFrameImageHandlers.isEmpty()) return nullptr;
+    if(relFrame < 0 || relFrame >= mFrameImageHandlers.count()) return nullptr;
     const auto& cacheHandler = mFrameImageHandlers.at(relFrame);
     if(!cacheHandler) return nullptr;
     return cacheHandler->getImageContainer();
@@ -39,38 +40,59 @@ ImageCacheContainer* ImageSequenceFileHandler::getFrameAtFrame(const int relFram
 
 ImageCacheContainer *ImageSequenceFileHandler::getFrameAtOrBeforeFrame(
         const int relFrame) {
-    if(mFrameImageHandlers.isEmpty()) return nullptr;
-    if(relFrame >= mFrameImageHandlers.count()) {
-        return mFrameImageHandlers.last()->getImageContainer();
-    }
-    const auto& cacheHandler = mFrameImageHandlers.at(relFrame);
+    if(mFrameImageHandlers.isEmpty() || relFrame < 0) return nullptr;
+    const int frame = qMin(relFrame, mFrameImageHandlers.count() - 1);
+    const auto& cacheHandler = mFrameImageHandlers.at(frame);
+    if(!cacheHandler) return nullptr;
     return cacheHandler->getImageContainer();
 }
 
 eTask *ImageSequenceFileHandler::scheduleFrameLoad(const int frame) {
-    if(mFrameImageHandlers.isEmpty()) return nullptr;
-    const auto& imageHandler = mFrameImageHandlers.at(frame);
+    const auto imageHandler = frameHandler(frame);
+    if(!imageHandler) return nullptr;
     if(imageHandler->hasImage()) return nullptr;
     return imageHandler->scheduleLoad();
 }
 
+void ImageSequenceFileHandler::prefetchFrames(const int frame,
+                                              const int direction,
+                                              const int count) {
+    if(direction == 0) return;
+    for(int i = 1; i <= count; i++) {
+        const int relFrame = frame + i*direction;
+        if(relFrame < 0 || relFrame >= mFramePaths.count()) break;
+        scheduleFrameLoad(relFrame);
+    }
+}
+
+ImageFileDataHandler* ImageSequenceFileHandler::frameHandler(
+        const int relFrame) {
+    if(relFrame < 0 || relFrame >= mFrameImageHandlers.count()) return nullptr;
+    auto& handler = mFrameImageHandlers[relFrame];
+    if(!handler) {
+        using IFDH = ImageFileDataHandler;
+        const auto& filePath = mFramePaths.at(relFrame);
+        handler = IFDH::sGetCreateDataHandler<IFDH>(filePath);
+    }
+    return handler.get();
+}
+
 void ImageSequenceFileHandler::reload() {
+    for(const auto& handler : mFrameImageHandlers) {
+        if(handler) handler->clearCache();
+    }
     mFrameImageHandlers.clear();
+    mFramePaths.clear();
     if(fileMissing()) return;
-    QDir dir(path());
-    dir.setFilter(QDir::Files);
-    dir.setSorting(QDir::Name);
-    const auto files = dir.entryInfoList();
-    for(const auto& fileInfo : files) {
-        const auto suffix = fileInfo.suffix();
+    const QDir dir(path());
+    const auto files = dir.entryList(QDir::Files, QDir::Name);
+    for(const auto& file : files) {
+        const auto suffix = file.section('.', -1);
         if(!isImageExt(suffix)) continue;
-        const auto filePath = fileInfo.absoluteFilePath();
-        using IFDH = ImageFileDataHandler;
-        const auto handler = IFDH::sGetCreateDataHandler<IFDH>(filePath);
-        handler->clearCache();
-        mFrameImageHandlers << handler;
+        mFramePaths << dir.absoluteFilePath(file);
     }
-    if(mFrameImageHandlers.isEmpty()) setMissing(true);
+    mFrameImageHandlers.resize(mFramePaths.count());
+    if(mFramePaths.isEmpty()) setMissing(true);
 }
 
 void ImageSequenceFileHandler::replace() {
@@ -81,3 +103,16 @@ void ImageSequenceFileHandler::replace() {
 ImageSequenceCacheHandler::ImageSequenceCacheHandler(
         ImageSequenceFileHandler *fileHandler) :
     mFileHandler(fileHandler) {}
+
+eTask* ImageSequenceCacheHandler::scheduleFrameLoad(const int frame) {
+    if(!mFileHandler) return nullptr;
+    const int step = frame - mLastFrame;
+    if(mLastFrame >= 0 && qAbs(step) <= 2 && step != 0) {
+        mDirection = step > 0 ? 1 : -1;
+    } else if(step != 0) mDirection = 0;
+    mLastFrame = frame;
+    const auto task = mFileHandler->scheduleFrameLoad(frame);
+    const int readAhead = eSettings::instance().fImageSequenceReadAhead;
+    mFileHandler->prefetchFrames(frame, mDirection, readAhead);
+    return task;
+}
@@ -37,9 +37,16 @@ public:
     ImageCacheContainer* getFrameAtFrame(const int relFrame);
     ImageCacheContainer* getFrameAtOrBeforeFrame(const int relFrame);
     eTask* scheduleFrameLoad(const int frame);
-    int getFrameCount() const { return mFrameImageHandlers.count(); }
+    //! @brief Schedules loading of up to count frames following frame
+    void prefetchFrames(const int frame, const int direction,
+                        const int count);
+    int getFrameCount() const { return mFramePaths.count(); }
 private:
-    QList<qsptr<ImageFileDataHandler>> mFrameImageHandlers;
+    ImageFileDataHandler* frameHandler(const int relFrame);
+
+    QStringList mFramePaths;
+    //! @brief Created on first use, a long sequence is only indexed by name
+    QVector<qsptr<ImageFileDataHandler>> mFrameImageHandlers;
 };
 
 class CORE_EXPORT ImageSequenceCacheHandler : public AnimationFrameHandler {
@@ -56,10 +63,7 @@ public:
         if(!mFileHandler) return nullptr;
         return mFileHandler->getFrameAtOrBeforeFrame(relFrame);
     }
-    eTask* scheduleFrameLoad(const int frame) {
-        if(!mFileHandler) return nullptr;
-        return mFileHandler->scheduleFrameLoad(frame);
-    }
+    eTask* scheduleFrameLoad(const int frame);
     void reload() {
         if(mFileHandler) mFileHandler->reloadAction();
     }
@@ -69,6 +73,8 @@ public:
     }
 private:
     const qptr<ImageSequenceFileHandler> mFileHandler;
+    int mLastFrame = -1;
+    int mDirection = 0;
 
 };
 #endif // IMAGESEQUENCECACHEHANDLER_H
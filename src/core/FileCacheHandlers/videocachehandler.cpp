@@ -32,32 +32,69 @@
 #include "filesourcescache.h"
 
 #include "videoframeloader.h"
+#include "videoproxygenerator.h"
+#include "Private/Tasks/taskscheduler.h"
+#include "Private/esettings.h"
+
+#include <QPointer>
+#include <QtMath>
 
 VideoFrameHandler::VideoFrameHandler(VideoDataHandler * const cacheHandler) :
     mDataHandler(cacheHandler) {
     openVideoStream();
+    connect(cacheHandler, &VideoDataHandler::proxyChanged,
+            this, &VideoFrameHandler::openProxyStream);
+    connect(cacheHandler, &VideoDataHandler::seekIndexChanged,
+            this, &VideoFrameHandler::updateSeekIndex);
 }
 
 ImageCacheContainer* VideoFrameHandler::getFrameAtFrame(const int relFrame) {
-    return mDataHandler->getFrameAtFrame(relFrame);
+    return mDataHandler->getFrameAtFrame(relFrame, 1);
 }
 
 ImageCacheContainer* VideoFrameHandler::getFrameAtOrBeforeFrame(const int relFrame) {
-    return mDataHandler->getFrameAtOrBeforeFrame(relFrame);
+    return mDataHandler->getFrameAtOrBeforeFrame(relFrame, 1);
+}
+
+ImageCacheContainer* VideoFrameHandler::getScaledFrameAtFrame(
+        const int relFrame, const int downscale) {
+    return mDataHandler->getFrameAtFrame(relFrame, downscale);
+}
+
+ImageCacheContainer* VideoFrameHandler::getScaledFrameAtOrBeforeFrame(
+        const int relFrame, const int downscale) {
+    return mDataHandler->getFrameAtOrBeforeFrame(relFrame, downscale);
+}
+
+int VideoFrameHandler::frameDownscale(const int downscale,
+                                      const bool preview) const {
+    Q_UNUSED(preview)
+    // streamsPool() picks the proxy once downscale reaches its downscale
+    return downscale;
+}
+
+const stdsptr<VideoStreamsPool>& VideoFrameHandler::streamsPool(
+        const int downscale) const {
+    if(mProxyStreams && downscale >= mProxyStreams->downscale())
+        return mProxyStreams;
+    return mVideoStreams;
 }
 
 void VideoFrameHandler::frameLoaderFinished(const int frame,
-                                            const sk_sp<SkImage>& image) {
-    mDataHandler->frameLoaderFinished(frame, image);
-    removeFrameLoader(frame);
+                                            const int downscale,
+                                            const VideoFrameData& data) {
+    mDataHandler->frameLoaderFinished(frame, downscale, data);
+    removeFrameLoader(frame, downscale);
 }
 
-void VideoFrameHandler::frameLoaderCanceled(const int frameId) {
-    removeFrameLoader(frameId);
+void VideoFrameHandler::frameLoaderCanceled(const int frameId,
+                                            const int downscale) {
+    removeFrameLoader(frameId, downscale);
 }
 
-void VideoFrameHandler::frameLoaderFailed(const int frameId) {
-    removeFrameLoader(frameId);
+void VideoFrameHandler::frameLoaderFailed(const int frameId,
+                                          const int downscale) {
+    removeFrameLoader(frameId, downscale);
     mDataHandler->setFrameCount(frameId);
 }
 
@@ -69,60 +106,150 @@ const HddCachableCacheHandler &VideoFrameHandler::getCacheHandler() const {
     return mDataHandler->getCacheHandler();
 }
 
-VideoFrameLoader *VideoFrameHandler::getFrameLoader(const int frame) {
-    return mDataHandler->getFrameLoader(frame);
+VideoFrameLoader *VideoFrameHandler::getFrameLoader(const int frame,
+                                                   const int downscale) {
+    return mDataHandler->getFrameLoader(frame, downscale);
 }
 
-VideoFrameLoader *VideoFrameHandler::addFrameLoader(const int frameId) {
+VideoFrameLoader *VideoFrameHandler::addFrameLoader(const int frameId,
+                                                   const int downscale,
+                                                   const int readAhead) {
+    const auto& streams = streamsPool(downscale);
     const auto loader = enve::make_shared<VideoFrameLoader>(
-                    this, mVideoStreamsData, frameId);
-    mDataHandler->addFrameLoader(frameId, loader);
-    for(const auto& nFrame : mNeededFrames) {
-        const auto nLoader = getFrameLoader(nFrame);
+                    this, streams, frameId, downscale);
+    mDataHandler->addFrameLoader(frameId, downscale, loader);
+    // frames being read ahead wait for this loader instead of seeking
+    int aheadCount = 0;
+    const int lastAheadId = qMin(frameId + readAhead, getFrameCount() - 1);
+    for(int i = frameId + 1; i <= lastAheadId; i++) {
+        if(getFrameLoader(i, downscale)) break;
+        if(mDataHandler->getFrameAtFrame(i, downscale)) break;
+        mDataHandler->addFrameLoader(i, downscale, loader);
+        aheadCount++;
+    }
+    loader->setReadAhead(aheadCount);
+    for(const auto& needed : mNeededFrames) {
+        const int nFrame = needed.first;
+        // only nearby frames are worth decoding in order,
+        // distant ones get their own context from the pool
+        if(streamsPool(needed.second) != streams ||
+           qAbs(nFrame - frameId) > streams->fps()) continue;
+        const auto nLoader = getFrameLoader(nFrame, needed.second);
         if(nFrame < frameId) nLoader->addDependent(loader.get());
         else loader->addDependent(nLoader);
     }
-    mNeededFrames.insert(frameId);
+    mNeededFrames.insert({frameId, downscale});
 
     return loader.get();
 }
 
 VideoFrameLoader *VideoFrameHandler::addFrameConverter(
-        const int frameId,  AVFrame * const frame) {
+        const int frameId, const int downscale,
+        const stdsptr<VideoStreamsPool>& streams, AVFrame * const frame) {
     const auto loader = enve::make_shared<VideoFrameLoader>(
-                    this, mVideoStreamsData, frameId, frame);
-    mDataHandler->addFrameLoader(frameId, loader);
+                    this, streams, frameId, downscale, frame);
+    mDataHandler->addFrameLoader(frameId, downscale, loader);
     return loader.get();
 }
 
-void VideoFrameHandler::removeFrameLoader(const int frame) {
-    mDataHandler->removeFrameLoader(frame);
-    mNeededFrames.erase(frame);
+void VideoFrameHandler::removeFrameLoader(const int frame,
+                                          const int downscale) {
+    mDataHandler->removeFrameLoader(frame, downscale);
+    mNeededFrames.erase(std::make_pair(frame, downscale));
 }
 
 void VideoFrameHandler::openVideoStream()
 {
     const auto filePath = mDataHandler->getFilePath();
-    mVideoStreamsData = VideoStreamsData::sOpen(filePath);
-    mDataHandler->setFrameCount(mVideoStreamsData->fFrameCount);
-    mDataHandler->setFps(mVideoStreamsData->fFps);
-    mDataHandler->setDim(QSize(mVideoStreamsData->fWidth,
-                               mVideoStreamsData->fHeight));
+    const auto primary = VideoStreamsData::sOpen(filePath);
+    mVideoStreams = std::make_shared<VideoStreamsPool>(primary);
+    mDataHandler->setFrameCount(primary->fFrameCount);
+    mDataHandler->setFps(primary->fFps);
+    mDataHandler->setDim(QSize(primary->fWidth, primary->fHeight));
+    updateSeekIndex();
+    openProxyStream();
+}
+
+void VideoFrameHandler::updateSeekIndex() {
+    if(mVideoStreams) mVideoStreams->setSeekIndex(mDataHandler->getSeekIndex());
+}
+
+void VideoFrameHandler::openProxyStream() {
+    mProxyStreams.reset();
+    if(!mDataHandler->hasProxy()) return;
+    stdsptr<VideoStreamsData> proxy;
+    try {
+        proxy = VideoStreamsData::sOpen(mDataHandler->getProxyPath(), false);
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+        return;
+    }
+    const int proxyWidth = qMax(1, proxy->fWidth);
+    const auto& src = mVideoStreams->primary();
+    proxy->fDownscale = qMax(1, qRound(static_cast<qreal>(src->fWidth)/proxyWidth));
+    proxy->fSrcWidth = src->fWidth;
+    proxy->fSrcHeight = src->fHeight;
+    mProxyStreams = std::make_shared<VideoStreamsPool>(proxy);
 }
 
 eTask* VideoFrameHandler::scheduleFrameLoad(const int frame) {
+    return scheduleScaledFrameLoad(frame, 1);
+}
+
+eTask* VideoFrameHandler::scheduleScaledFrameLoad(const int frame,
+                                                  const int downscale) {
     if(frame < 0 || frame >= getFrameCount())
         RuntimeThrow("Frame outside of range " + std::to_string(frame));
-    const auto currLoader = getFrameLoader(frame);
+    const int readAhead = readAheadCount(frame, downscale);
+    const auto task = loadFrame(frame, downscale, readAhead);
+    if(readAhead > 0) scheduleReadAhead(frame, downscale, readAhead);
+    return task;
+}
+
+eTask* VideoFrameHandler::loadFrame(const int frame, const int downscale,
+                                    const int readAhead) {
+    const auto currLoader = getFrameLoader(frame, downscale);
     if(currLoader) return currLoader;
-    if(mDataHandler->getFrameAtFrame(frame)) return nullptr;
-    const auto loadTask = mDataHandler->scheduleFrameHddCacheLoad(frame);
+    if(mDataHandler->getFrameAtFrame(frame, downscale)) return nullptr;
+    const auto loadTask = mDataHandler->scheduleFrameHddCacheLoad(
+                frame, downscale);
     if(loadTask) return loadTask;
-    const auto loader = addFrameLoader(frame);
+    const auto loader = addFrameLoader(frame, downscale, readAhead);
     loader->queTask();
     return loader;
 }
 
+int VideoFrameHandler::readAheadCount(const int frame, const int downscale) {
+    const int step = frame - mLastRequested;
+    mLastRequested = frame;
+    if(step > 0 && step <= 2) mSequentialRequests++;
+    else if(step != 0) mSequentialRequests = 0;
+    if(mSequentialRequests < 2) return 0;
+
+    const auto& streams = streamsPool(downscale);
+    const auto& primary = streams->primary();
+    const int width = sDownscaledSize(primary->fSrcWidth, downscale);
+    const int height = sDownscaledSize(primary->fSrcHeight, downscale);
+    const qint64 frameBytes = qMax(qint64(1), qint64(width)*height*4);
+    const qint64 budget = qint64(eSettings::sRamMBCap().fValue)*1024*1024/32;
+    // chunks stay within a second, so they get chained by addFrameLoader
+    const int maxCount = qMin(16, qFloor(streams->fps()) - 1);
+    return qBound(0, static_cast<int>(budget/frameBytes), maxCount);
+}
+
+void VideoFrameHandler::scheduleReadAhead(const int frame, const int downscale,
+                                          const int readAhead) {
+    // keep at least half of the window ahead decoded or being decoded
+    const int lastId = qMin(frame + readAhead/2, getFrameCount() - 1);
+    for(int i = frame + 1; i <= lastId; i++) {
+        if(getFrameLoader(i, downscale)) continue;
+        if(mDataHandler->getFrameAtFrame(i, downscale)) continue;
+        const auto loader = addFrameLoader(i, downscale, readAhead);
+        loader->queTask();
+        return;
+    }
+}
+
 int VideoFrameHandler::getFrameCount() const {
     return mDataHandler->getFrameCount();
 }
@@ -137,7 +264,7 @@ void VideoFrameHandler::afterSourceChanged() {
 }
 
 void VideoDataHandler::clearCache() {
-    mFramesCache.clear();
+    for(auto& cache : mFramesCache) cache.clear();
     mFramesBeingLoaded.clear();
     const auto frameLoaders = mFrameLoaders;
     for(const auto& loader : frameLoaders)
@@ -145,6 +272,10 @@ void VideoDataHandler::clearCache() {
     mFrameLoaders.clear();
 }
 
+void VideoFileHandler::generateProxy() {
+    if(mDataHandler) mDataHandler->generateProxy();
+}
+
 void VideoFileHandler::replace() {
     const QString importPath = eDialogs::openFile(
                 "Replace Video Source " + path(), path(),
@@ -163,57 +294,151 @@ void VideoFileHandler::replace() {
 }
 
 void VideoDataHandler::afterSourceChanged() {
+    updateProxy();
+    updateSeekIndex();
     for(const auto& handler : mFrameHandlers) {
         handler->afterSourceChanged();
     }
 }
 
+void VideoDataHandler::updateProxy() {
+    const QString proxyPath = mFileMissing ? QString() :
+                VideoProxyGenerator::sProxyPath(mFilePath);
+    if(mProxyGenerator && mProxyGenerator->proxyPath() != proxyPath) {
+        mProxyGenerator->cancel();
+        mProxyGenerator.reset();
+    }
+    const QString oldPath = mProxyPath;
+    if(!proxyPath.isEmpty() && QFile::exists(proxyPath)) {
+        mProxyPath = proxyPath;
+    } else {
+        mProxyPath.clear();
+        if(eSettings::instance().fVideoProxies) generateProxy();
+    }
+    if(oldPath != mProxyPath) emit proxyChanged();
+}
+
+void VideoDataHandler::updateSeekIndex() {
+    const QString path = mFileMissing ? QString() : mFilePath;
+    if(mSeekIndexLoader) {
+        if(mSeekIndexLoader->srcPath() == path) return;
+        mSeekIndexLoader->abort();
+        mSeekIndexLoader.reset();
+    }
+    if(mSeekIndex) {
+        mSeekIndex.reset();
+        emit seekIndexChanged();
+    }
+    if(path.isEmpty()) return;
+    const QPointer<VideoDataHandler> ptr = this;
+    const auto finished = [ptr](const stdsptr<const VideoSeekIndex>& index) {
+        if(!ptr) return;
+        ptr->mSeekIndexLoader.reset();
+        if(!index) return;
+        ptr->mSeekIndex = index;
+        emit ptr->seekIndexChanged();
+    };
+    mSeekIndexLoader = enve::make_shared<VideoSeekIndexLoader>(path, finished);
+    mSeekIndexLoader->queTask();
+}
+
+void VideoDataHandler::generateProxy() {
+    if(mFileMissing || hasProxy() || mProxyGenerator) return;
+    const QString proxyPath = VideoProxyGenerator::sProxyPath(mFilePath);
+    VideoProxyGenerator* task;
+    try {
+        task = new VideoProxyGenerator(mFilePath, proxyPath);
+    } catch(const std::exception& e) {
+        gPrintExceptionCritical(e);
+        return;
+    }
+    mProxyGenerator = qsptr<VideoProxyGenerator>(task, &QObject::deleteLater);
+    connect(task, &ComplexTask::finishedAll, this, [this, proxyPath]() {
+        mProxyGenerator.reset();
+        mProxyPath = proxyPath;
+        emit proxyChanged();
+    });
+    connect(task, &ComplexTask::canceled, this, [this, task]() {
+        if(mProxyGenerator == task) mProxyGenerator.reset();
+    });
+    task->nextStep();
+    TaskScheduler::instance()->addComplexTask(mProxyGenerator);
+}
+
 const HddCachableCacheHandler &VideoDataHandler::getCacheHandler() const {
-    return mFramesCache;
+    return mFramesCache[0];
+}
+
+HddCachableCacheHandler &VideoDataHandler::framesCache(const int downscale) {
+    switch(downscale) {
+    case 8: return mFramesCache[3];
+    case 4: return mFramesCache[2];
+    case 2: return mFramesCache[1];
+    default: return mFramesCache[0];
+    }
+}
+
+const HddCachableCacheHandler &VideoDataHandler::framesCache(
+        const int downscale) const {
+    return const_cast<VideoDataHandler*>(this)->framesCache(downscale);
 }
 
-void VideoDataHandler::addFrameLoader(const int frameId,
+void VideoDataHandler::addFrameLoader(const int frameId, const int downscale,
                                       const stdsptr<VideoFrameLoader> &loader) {
-    mFramesBeingLoaded << frameId;
+    mFramesBeingLoaded << qMakePair(frameId, downscale);
     mFrameLoaders << loader;
 }
 
-VideoFrameLoader *VideoDataHandler::getFrameLoader(const int frame) const {
-    const int id = mFramesBeingLoaded.indexOf(frame);
+VideoFrameLoader *VideoDataHandler::getFrameLoader(const int frame,
+                                                   const int downscale) const {
+    const int id = mFramesBeingLoaded.indexOf(qMakePair(frame, downscale));
     if(id >= 0) return mFrameLoaders.at(id).get();
     return nullptr;
 }
 
-void VideoDataHandler::removeFrameLoader(const int frame) {
-    const int id = mFramesBeingLoaded.indexOf(frame);
+void VideoDataHandler::removeFrameLoader(const int frame,
+                                         const int downscale) {
+    const int id = mFramesBeingLoaded.indexOf(qMakePair(frame, downscale));
     if(id < 0 || id >= mFramesBeingLoaded.count()) return;
     mFramesBeingLoaded.removeAt(id);
     mFrameLoaders.removeAt(id);
 }
 
 void VideoDataHandler::frameLoaderFinished(const int frame,
-                                           const sk_sp<SkImage> &image) {
-    if(image) {
-        mFramesCache.add(enve::make_shared<ImageCacheContainer>(
-                             image, FrameRange{frame, frame}, &mFramesCache));
+                                           const int downscale,
+                                           const VideoFrameData &data) {
+    auto& cache = framesCache(downscale);
+    const FrameRange range{frame, frame};
+    if(data.fYuv) {
+        cache.add(enve::make_shared<ImageCacheContainer>(
+                      data.fYuv, range, &cache));
+    } else if(data.fImage) {
+        cache.add(enve::make_shared<ImageCacheContainer>(
+                      data.fImage, range, &cache));
     } else {
         mFrameCount = frame;
         emit frameCountUpdated(mFrameCount);
     }
 }
 
-eTask *VideoDataHandler::scheduleFrameHddCacheLoad(const int frame) {
-    const auto contAtFrame = mFramesCache.atFrame<ImageCacheContainer>(frame);
+eTask *VideoDataHandler::scheduleFrameHddCacheLoad(const int frame,
+                                                   const int downscale) {
+    const auto& cache = framesCache(downscale);
+    const auto contAtFrame = cache.atFrame<ImageCacheContainer>(frame);
     if(contAtFrame) return contAtFrame->scheduleLoadFromTmpFile();
     return nullptr;
 }
 
-ImageCacheContainer* VideoDataHandler::getFrameAtFrame(const int relFrame) const {
-    return mFramesCache.atFrame<ImageCacheContainer>(relFrame);
+ImageCacheContainer* VideoDataHandler::getFrameAtFrame(
+        const int relFrame, const int downscale) const {
+    const auto& cache = framesCache(downscale);
+    return cache.atFrame<ImageCacheContainer>(relFrame);
 }
 
-ImageCacheContainer* VideoDataHandler::getFrameAtOrBeforeFrame(const int relFrame) const {
-    return mFramesCache.atOrBeforeFrame<ImageCacheContainer>(relFrame);
+ImageCacheContainer* VideoDataHandler::getFrameAtOrBeforeFrame(
+        const int relFrame, const int downscale) const {
+    const auto& cache = framesCache(downscale);
+    return cache.atOrBeforeFrame<ImageCacheContainer>(relFrame);
 }
 
 int VideoDataHandler::getFrameCount() const { return mFrameCount; }
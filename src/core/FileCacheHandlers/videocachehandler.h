@@ -27,14 +27,24 @@
 #define VIDEOCACHEHANDLER_H
 
 #include "animationcachehandler.h"
-#include "videostreamsdata.h"
+#include "videostreamspool.h"
 #include "filecachehandler.h"
 #include "CacheHandlers/hddcachablecachehandler.h"
+#include "CacheHandlers/yuvimage.h"
 
 #include <set>
 
 class VideoFrameLoader;
 class VideoFrameHandler;
+class VideoProxyGenerator;
+
+//! @brief Decoded frame, kept as YUV when its pixel format allows it
+struct CORE_EXPORT VideoFrameData {
+    sk_sp<SkImage> fImage;
+    stdsptr<YuvImage> fYuv;
+
+    bool isNull() const { return !fImage && !fYuv; }
+};
 
 class CORE_EXPORT VideoDataHandler : public FileDataCacheHandler {
     Q_OBJECT
@@ -44,32 +54,62 @@ public:
     void clearCache();
     void afterSourceChanged();
 
+    //! @brief Full size frames
     const HddCachableCacheHandler& getCacheHandler() const;
 
-    void addFrameLoader(const int frameId, const stdsptr<VideoFrameLoader>& loader);
-    VideoFrameLoader * getFrameLoader(const int frame) const;
-    void removeFrameLoader(const int frame);
-    void frameLoaderFinished(const int frame, const sk_sp<SkImage>& image);
-    eTask* scheduleFrameHddCacheLoad(const int frame);
-    ImageCacheContainer* getFrameAtFrame(const int relFrame) const;
-    ImageCacheContainer* getFrameAtOrBeforeFrame(const int relFrame) const;
+    void addFrameLoader(const int frameId, const int downscale,
+                        const stdsptr<VideoFrameLoader>& loader);
+    VideoFrameLoader * getFrameLoader(const int frame,
+                                      const int downscale) const;
+    void removeFrameLoader(const int frame, const int downscale);
+    void frameLoaderFinished(const int frame, const int downscale,
+                             const VideoFrameData& data);
+    eTask* scheduleFrameHddCacheLoad(const int frame, const int downscale);
+    ImageCacheContainer* getFrameAtFrame(const int relFrame,
+                                         const int downscale) const;
+    ImageCacheContainer* getFrameAtOrBeforeFrame(const int relFrame,
+                                                 const int downscale) const;
     int getFrameCount() const;
     void setFrameCount(const int count);
     qreal getFps() const;
     void setFps(const qreal fps);
     const QSize getDim();
     void setDim(const QSize dim);
+
+    //! @brief Starts background generation of a preview proxy
+    void generateProxy();
+    bool hasProxy() const { return !mProxyPath.isEmpty(); }
+    bool isGeneratingProxy() const { return !mProxyGenerator.isNull(); }
+    const QString& getProxyPath() const { return mProxyPath; }
+
+    //! @brief Keyframe index of the source, nullptr until it is built
+    const stdsptr<const VideoSeekIndex>& getSeekIndex() const
+    { return mSeekIndex; }
 signals:
     void frameCountUpdated(int);
+    void proxyChanged();
+    void seekIndexChanged();
 private:
+    void updateProxy();
+    //! @brief Loads the cached index or builds it in the background
+    void updateSeekIndex();
+
+    HddCachableCacheHandler& framesCache(const int downscale);
+    const HddCachableCacheHandler& framesCache(const int downscale) const;
+
     int mFrameCount = 0;
     qreal mFrameFps = 0;
     int mFrameWidth = 0;
     int mFrameHeight = 0;
     QList<VideoFrameHandler*> mFrameHandlers;
-    QList<int> mFramesBeingLoaded;
+    QList<QPair<int, int>> mFramesBeingLoaded;
     QList<stdsptr<VideoFrameLoader>> mFrameLoaders;
-    HddCachableCacheHandler mFramesCache;
+    //! @brief One cache per downscale tier, i.e., 1, 2, 4 and 8
+    HddCachableCacheHandler mFramesCache[4];
+    QString mProxyPath;
+    qsptr<VideoProxyGenerator> mProxyGenerator;
+    stdsptr<const VideoSeekIndex> mSeekIndex;
+    stdsptr<VideoSeekIndexLoader> mSeekIndexLoader;
 };
 
 class CORE_EXPORT VideoFrameHandler : public AnimationFrameHandler {
@@ -84,26 +124,53 @@ public:
     int getFrameCount() const;
     void reload();
 
+    ImageCacheContainer* getScaledFrameAtFrame(
+            const int relFrame, const int downscale);
+    ImageCacheContainer* getScaledFrameAtOrBeforeFrame(
+            const int relFrame, const int downscale);
+    eTask* scheduleScaledFrameLoad(const int frame, const int downscale);
+    int frameDownscale(const int downscale, const bool preview) const;
+
     void afterSourceChanged();
 
-    void frameLoaderFinished(const int frame, const sk_sp<SkImage>& image);
-    void frameLoaderCanceled(const int frameId);
-    void frameLoaderFailed(const int frameId);
+    void frameLoaderFinished(const int frame, const int downscale,
+                             const VideoFrameData& data);
+    void frameLoaderCanceled(const int frameId, const int downscale);
+    void frameLoaderFailed(const int frameId, const int downscale);
 
     VideoDataHandler* getDataHandler() const;
     const HddCachableCacheHandler& getCacheHandler() const;
 protected:
-    VideoFrameLoader * getFrameLoader(const int frame);
-    VideoFrameLoader * addFrameLoader(const int frameId);
-    VideoFrameLoader * addFrameConverter(const int frameId, AVFrame * const frame);
-    void removeFrameLoader(const int frame);
+    VideoFrameLoader * getFrameLoader(const int frame, const int downscale);
+    VideoFrameLoader * addFrameLoader(const int frameId, const int downscale,
+                                      const int readAhead = 0);
+    VideoFrameLoader * addFrameConverter(
+            const int frameId, const int downscale,
+            const stdsptr<VideoStreamsPool>& streams, AVFrame * const frame);
+    void removeFrameLoader(const int frame, const int downscale);
 
     void openVideoStream();
+    void openProxyStream();
+    void updateSeekIndex();
 private:
-    std::set<int> mNeededFrames;
+    //! @brief Proxy for preview downscales it covers, source otherwise
+    const stdsptr<VideoStreamsPool>& streamsPool(const int downscale) const;
+
+    eTask* loadFrame(const int frame, const int downscale,
+                     const int readAhead);
+    //! @brief Number of frames to decode ahead of frame,
+    //! non-zero once requests become sequential
+    int readAheadCount(const int frame, const int downscale);
+    void scheduleReadAhead(const int frame, const int downscale,
+                           const int readAhead);
+
+    std::set<std::pair<int, int>> mNeededFrames;
+    int mLastRequested = -1;
+    int mSequentialRequests = 0;
 
     VideoDataHandler* const mDataHandler;
-    stdsptr<VideoStreamsData> mVideoStreamsData;
+    stdsptr<VideoStreamsPool> mVideoStreams;
+    stdsptr<VideoStreamsPool> mProxyStreams;
 };
 #include "CacheHandlers/soundcachehandler.h"
 class CORE_EXPORT VideoFileHandler : public FileCacheHandler {
@@ -114,6 +181,7 @@ protected:
     void reload();
 public:
     void replace();
+    void generateProxy();
 
     VideoDataHandler* getFrameHandler() const {
         return mDataHandler.get();
@@ -27,18 +27,21 @@
 #include "videocachehandler.h"
 #include "Private/Tasks/taskscheduler.h"
 #include "Private/Tasks/taskexecutor.h"
+#include "swscontextcache.h"
 
 VideoFrameLoader::VideoFrameLoader(VideoFrameHandler * const cacheHandler,
-                                   const stdsptr<VideoStreamsData> &openedVideo,
-                                   const int frameId) :
-    mCacheHandler(cacheHandler), mOpenedVideo(openedVideo),
-    mFrameId(frameId) {}
+                                   const stdsptr<VideoStreamsPool> &streams,
+                                   const int frameId,
+                                   const int downscale) :
+    mCacheHandler(cacheHandler), mStreams(streams),
+    mFrameId(frameId), mDownscale(downscale) {}
 
 VideoFrameLoader::VideoFrameLoader(VideoFrameHandler * const cacheHandler,
-                                   const stdsptr<VideoStreamsData> &openedVideo,
-                                   const int frameId, AVFrame * const frame) :
-    VideoFrameLoader(cacheHandler, openedVideo, frameId) {
-    setFrameToConvert(frame, openedVideo->fCodecContext);
+                                   const stdsptr<VideoStreamsPool> &streams,
+                                   const int frameId, const int downscale,
+                                   AVFrame * const frame) :
+    VideoFrameLoader(cacheHandler, streams, frameId, downscale) {
+    setFrameToConvert(frame);
 }
 
 VideoFrameLoader::~VideoFrameLoader() {
@@ -46,12 +49,39 @@ VideoFrameLoader::~VideoFrameLoader() {
         av_frame_unref(excess.second);
         av_frame_free(&excess.second);
     }
+    for(auto& ahead : mReadAheadFrames) {
+        av_frame_unref(ahead.second);
+        av_frame_free(&ahead.second);
+    }
     cleanUp();
+    unreserve();
+}
+
+void VideoFrameLoader::unreserve() {
+    if(!mReserved) return;
+    mStreams->unreserve();
+    mReserved = false;
 }
 
-void VideoFrameLoader::convertFrame() {
-    const auto info = SkiaHelpers::getPremulRGBAInfo(
-                mFrameToConvert->width, mFrameToConvert->height);
+VideoFrameData VideoFrameLoader::convertFrame(AVFrame * const frame) {
+    // sized from the original, so proxy frames match decoded frames
+    const auto& primary = mStreams->primary();
+    const int dstWidth = AnimationFrameHandler::sDownscaledSize(
+                primary->fSrcWidth, mDownscale);
+    const int dstHeight = AnimationFrameHandler::sDownscaledSize(
+                primary->fSrcHeight, mDownscale);
+    // reduced size frames are used for preview only
+    const int flags = mDownscale > 1 ? SWS_FAST_BILINEAR : SWS_BICUBIC;
+    VideoFrameData result;
+    // YUV takes 1.5 bytes per pixel, it is converted to RGBA when drawn
+    result.fYuv = YuvImage::sFromFrame(frame, dstWidth, dstHeight, flags);
+    if(result.fYuv) return result;
+
+    const SwsContextCache::Conversion conv{
+        static_cast<AVPixelFormat>(frame->format), frame->width, frame->height,
+        AV_PIX_FMT_RGBA, dstWidth, dstHeight, flags};
+
+    const auto info = SkiaHelpers::getPremulRGBAInfo(dstWidth, dstHeight);
     SkBitmap bitmap;
     bitmap.allocPixels(info);
 
@@ -62,13 +92,24 @@ void VideoFrameLoader::convertFrame() {
     uint8_t * const dstSk[] = { static_cast<uint8_t*>(addr) };
     int linesizesSk[4];
 
-    av_image_fill_linesizes(linesizesSk, AV_PIX_FMT_RGBA,
-                            mFrameToConvert->width);
+    av_image_fill_linesizes(linesizesSk, AV_PIX_FMT_RGBA, dstWidth);
 
-    sws_scale(mSwsContext, mFrameToConvert->data, mFrameToConvert->linesize,
-              0, mFrameToConvert->height, dstSk, linesizesSk);
+    if(!SwsContextCache::sScale(conv, frame->data, frame->linesize,
+                                dstSk, linesizesSk))
+        RuntimeThrow("Cannot initialize the conversion context");
 
-    mLoadedFrame = SkiaHelpers::transferDataToSkImage(bitmap);
+    result.fImage = SkiaHelpers::transferDataToSkImage(bitmap);
+    return result;
+}
+
+void VideoFrameLoader::convertFrames() {
+    mLoadedFrame = convertFrame(mFrameToConvert);
+    for(auto& ahead : mReadAheadFrames) {
+        mReadAheadImages.insert(ahead.first, convertFrame(ahead.second));
+        av_frame_unref(ahead.second);
+        av_frame_free(&ahead.second);
+    }
+    mReadAheadFrames.clear();
 
     cleanUp();
 }
@@ -76,12 +117,19 @@ void VideoFrameLoader::convertFrame() {
 int frameId(AVFrame * const decodedFrame,
             AVStream * const videoStream,
             const qreal fps) {
-    int64_t pts = decodedFrame->best_effort_timestamp;
-    pts = av_rescale_q(pts, videoStream->time_base, {1, AV_TIME_BASE});
-    const qreal frameApprox = pts/1000000.*fps;
-    const int frameRound = qRound(frameApprox);
-    if(frameRound - frameApprox > 0.4) return frameRound - 1;
-    return frameRound;
+    return VideoSeekIndex::sFrameId(decodedFrame->best_effort_timestamp,
+                                    videoStream->time_base, fps);
+}
+
+bool seekExact(const VideoSeekIndex& index, const int frameId,
+               AVFormatContext * const formatContext,
+               const int videoStreamIndex,
+               AVCodecContext * const codecContext) {
+    const int64_t keyPts = index.keyframePts(frameId);
+    if(avformat_seek_file(formatContext, videoStreamIndex,
+                          INT64_MIN, keyPts, keyPts, 0) < 0) return false;
+    avcodec_flush_buffers(codecContext);
+    return true;
 }
 
 void seek(const int tryN, const int frameId, const qreal fps,
@@ -109,53 +157,80 @@ void seek(const int tryN, const int frameId, const qreal fps,
 }
 
 void VideoFrameLoader::readFrame() {
-    if(!mOpenedVideo->fOpened)
+    const auto openedVideo = mStreams->acquire(mFrameId);
+    try {
+        readFrame(openedVideo.get());
+    } catch(...) {
+        mStreams->release(openedVideo);
+        unreserve();
+        throw;
+    }
+    mStreams->release(openedVideo);
+    unreserve();
+}
+
+void VideoFrameLoader::readFrame(VideoStreamsData * const openedVideo) {
+    if(!openedVideo->fOpened)
         RuntimeThrow("Cannot read frame from closed VideoStream");
-    const auto formatContext = mOpenedVideo->fFormatContext;
-    const auto videoStreamIndex = mOpenedVideo->fVideoStreamIndex;
-    const auto videoStream = mOpenedVideo->fVideoStream;
-    const auto packet = mOpenedVideo->fPacket;
-    const auto codecContext = mOpenedVideo->fCodecContext;
-    auto& decodedFrame = mOpenedVideo->fDecodedFrame;
-    //const auto swsContext = mOpenedVideo->fSwsContext;
-    const qreal fps = mOpenedVideo->fFps;
+    const auto formatContext = openedVideo->fFormatContext;
+    const auto videoStreamIndex = openedVideo->fVideoStreamIndex;
+    const auto videoStream = openedVideo->fVideoStream;
+    const auto packet = openedVideo->fPacket;
+    const auto codecContext = openedVideo->fCodecContext;
+    auto& decodedFrame = openedVideo->fDecodedFrame;
+    const qreal fps = openedVideo->fFps;
+    const auto index = mStreams->seekIndex();
 
     int seekTry = 0;
-    if(mOpenedVideo->fLastFrame >= mFrameId ||
-       mFrameId - mOpenedVideo->fLastFrame > fps) {
+    // lands on the keyframe of mFrameId, no need to seek again
+    bool exactSeek = false;
+    const int lastFrame = openedVideo->fLastFrame;
+    if(index) {
+        // decode forward unless a keyframe lies between
+        if(lastFrame >= mFrameId || index->keyframeId(mFrameId) > lastFrame) {
+            exactSeek = seekExact(*index, mFrameId, formatContext,
+                                  videoStreamIndex, codecContext);
+            if(!exactSeek) seek(seekTry++, mFrameId, fps, formatContext,
+                                videoStreamIndex, videoStream, codecContext);
+        } else exactSeek = true;
+    } else if(lastFrame >= mFrameId || mFrameId - lastFrame > fps) {
         seek(seekTry++, mFrameId, fps, formatContext,
              videoStreamIndex, videoStream, codecContext);
     }
 
     while(true) {
-        const int lastFrameTmp = mOpenedVideo->fLastFrame;
-        mOpenedVideo->fLastFrame = -qFloor(10*fps); // Just in case error occurs
-        const int readRet = av_read_frame(formatContext, packet);
-        if(readRet < 0) NoBreakRuntimeThrow("Error retrieving AVPacket");
-        if(packet->stream_index == videoStreamIndex) {
-            const int sendRet = avcodec_send_packet(codecContext, packet);
-            if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
-
-            const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
-            av_packet_unref(packet);
-
-            if(recRet == AVERROR_EOF)
-                break;
-            else if(recRet == AVERROR(EAGAIN))
-                continue;
-            else if(recRet < 0)
-                RuntimeThrow("Did not receive frame from the decoder");
-        } else {
-            av_packet_unref(packet);
+        const int lastFrameTmp = openedVideo->fLastFrame;
+        openedVideo->fLastFrame = -qFloor(10*fps); // Just in case error occurs
+        // take every frame the decoder holds before sending the next packet
+        const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
+        if(recRet == AVERROR(EAGAIN)) {
+            const int readRet = av_read_frame(formatContext, packet);
+            if(readRet < 0) {
+                // end of file, flush the frames the decoder still holds
+                if(avcodec_send_packet(codecContext, nullptr) < 0)
+                    NoBreakRuntimeThrow("Error retrieving AVPacket");
+            } else {
+                const bool video = packet->stream_index == videoStreamIndex;
+                const int sendRet = video ?
+                            avcodec_send_packet(codecContext, packet) : 0;
+                av_packet_unref(packet);
+                if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
+            }
+            openedVideo->fLastFrame = lastFrameTmp;
             continue;
+        } else if(recRet == AVERROR_EOF) {
+            NoBreakRuntimeThrow("Error retrieving AVPacket");
+        } else if(recRet < 0) {
+            RuntimeThrow("Did not receive frame from the decoder");
         }
 
         const int currFrame = frameId(decodedFrame, videoStream, fps);
         const bool usePrevious = mFrameId > lastFrameTmp &&
                                  currFrame > mFrameId &&
                                  !mExcessFrames.isEmpty();
-        mOpenedVideo->fLastFrame = currFrame;
-        const bool reseek = currFrame > mFrameId && seekTry <= 3;
+        openedVideo->fLastFrame = currFrame;
+        const bool reseek = !exactSeek && currFrame > mFrameId &&
+                            seekTry <= 3;
         if(usePrevious) {
             int minPositiveDist = INT_MAX;
             int excessId = -1;
@@ -172,15 +247,18 @@ void VideoFrameLoader::readFrame() {
                 decodedFrame = av_frame_alloc();
             } else {
                 frame = mExcessFrames.takeAt(excessId).second;
-                av_frame_unref(decodedFrame);
+                if(currFrame <= mFrameId + mReadAhead) {
+                    mReadAheadFrames.append({currFrame, decodedFrame});
+                    decodedFrame = av_frame_alloc();
+                } else av_frame_unref(decodedFrame);
             }
-            setFrameToConvert(frame, codecContext);
+            setFrameToConvert(frame);
             break;
         } else if(currFrame == mFrameId || (!reseek && currFrame > mFrameId)) {
             if(currFrame > mFrameId)
                 qDebug() << "frame " + QString::number(currFrame) +
                             " instead of " + QString::number(mFrameId);            
-            setFrameToConvert(decodedFrame, codecContext);
+            setFrameToConvert(decodedFrame);
             decodedFrame = av_frame_alloc();
             break;
         } else if(qAbs(mFrameId - currFrame) < 20) {
@@ -191,28 +269,82 @@ void VideoFrameLoader::readFrame() {
         if(reseek) seek(seekTry++, mFrameId, fps, formatContext,
                         videoStreamIndex, videoStream, codecContext);
     }
+    if(mFrameToConvert && mReadAhead > 0) readAheadFrames(openedVideo);
+}
+
+void VideoFrameLoader::readAheadFrames(VideoStreamsData * const openedVideo) {
+    const auto formatContext = openedVideo->fFormatContext;
+    const auto videoStreamIndex = openedVideo->fVideoStreamIndex;
+    const auto videoStream = openedVideo->fVideoStream;
+    const auto packet = openedVideo->fPacket;
+    const auto codecContext = openedVideo->fCodecContext;
+    auto& decodedFrame = openedVideo->fDecodedFrame;
+    const qreal fps = openedVideo->fFps;
+
+    const int lastAheadId = mFrameId + mReadAhead;
+    while(openedVideo->fLastFrame < lastAheadId) {
+        const int lastFrame = openedVideo->fLastFrame;
+        openedVideo->fLastFrame = -qFloor(10*fps); // Just in case error occurs
+        const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
+        if(recRet == AVERROR(EAGAIN)) {
+            const int readRet = av_read_frame(formatContext, packet);
+            if(readRet < 0) break;
+            const bool video = packet->stream_index == videoStreamIndex;
+            const int sendRet = video ?
+                        avcodec_send_packet(codecContext, packet) : 0;
+            av_packet_unref(packet);
+            if(sendRet < 0) break;
+            openedVideo->fLastFrame = lastFrame;
+            continue;
+        } else if(recRet < 0) break;
+
+        const int currFrame = frameId(decodedFrame, videoStream, fps);
+        openedVideo->fLastFrame = currFrame;
+        if(currFrame > lastFrame && currFrame <= lastAheadId) {
+            mReadAheadFrames.append({currFrame, decodedFrame});
+            decodedFrame = av_frame_alloc();
+        } else av_frame_unref(decodedFrame);
+    }
+}
+
+void VideoFrameLoader::releaseReadAhead(const bool finished) {
+    for(int i = mFrameId + 1; i <= mFrameId + mReadAhead; i++) {
+        if(mCacheHandler->getFrameLoader(i, mDownscale) != this) continue;
+        VideoFrameData data;
+        if(finished) data = mReadAheadImages.value(i);
+        if(!data.isNull()) {
+            mCacheHandler->frameLoaderFinished(i, mDownscale, data);
+        }
+        else mCacheHandler->frameLoaderCanceled(i, mDownscale);
+    }
+    mReadAheadImages.clear();
 }
 
 void VideoFrameLoader::afterProcessing() {
     if(!mCacheHandler) return;
-    mCacheHandler->frameLoaderFinished(mFrameId, mLoadedFrame);
+    mCacheHandler->frameLoaderFinished(mFrameId, mDownscale, mLoadedFrame);
+    releaseReadAhead(true);
     for(auto& excess : mExcessFrames) {
-        if(mCacheHandler->getFrameAtFrame(excess.first)) {
+        if(mCacheHandler->getScaledFrameAtFrame(excess.first, mDownscale)) {
             av_frame_unref(excess.second);
             av_frame_free(&excess.second);
             continue;
         }
-        const auto currFL = mCacheHandler->getFrameLoader(excess.first);
+        const auto currFL = mCacheHandler->getFrameLoader(excess.first,
+                                                          mDownscale);
         if(currFL) {
-            if(currFL->getState() >= eTaskState::processing) {
+            if(currFL->getState() >= eTaskState::processing ||
+               currFL->mStreams != mStreams ||
+               currFL->mFrameId != excess.first ||
+               currFL->mReadAhead > 0) {
                 av_frame_unref(excess.second);
                 av_frame_free(&excess.second);
                 continue;
             }
-            currFL->setFrameToConvert(excess.second, mOpenedVideo->fCodecContext);
+            currFL->setFrameToConvert(excess.second);
         } else {
             const auto newFL = mCacheHandler->addFrameConverter(
-                        excess.first, excess.second);
+                        excess.first, mDownscale, mStreams, excess.second);
             newFL->queTask();
         }
     }
@@ -221,7 +353,8 @@ void VideoFrameLoader::afterProcessing() {
 
 void VideoFrameLoader::afterCanceled() {
     if(!mCacheHandler) return;
-    mCacheHandler->frameLoaderCanceled(mFrameId);
+    mCacheHandler->frameLoaderCanceled(mFrameId, mDownscale);
+    releaseReadAhead(false);
 }
 
 bool VideoFrameLoader::handleException() {
@@ -231,38 +364,33 @@ bool VideoFrameLoader::handleException() {
         finishedProcessing();
         return false;
     }
-    const auto moved = mCacheHandler->addFrameLoader(mFrameId - 1);
+    releaseReadAhead(false);
+    const auto moved = mCacheHandler->addFrameLoader(mFrameId - 1,
+                                                     mDownscale);
     moveDependent(moved);
-    mCacheHandler->frameLoaderFailed(mFrameId);
+    mCacheHandler->frameLoaderFailed(mFrameId, mDownscale);
     moved->queTask();
     return true;
 }
 
 void VideoFrameLoader::queTaskNow() {
-    if(mFrameToConvert) {
+    if(!mFrameToConvert && !mReserved) mReserved = mStreams->reserve();
+    // with a context to spare decoding runs in parallel on a cpu thread
+    if(mFrameToConvert || mReserved) {
         TaskScheduler::instance()->queCpuTask(ref<eTask>());
     } else {
         TaskScheduler::instance()->queHddTask(ref<eTask>());
     }
 }
 
-void VideoFrameLoader::setFrameToConvert(
-        AVFrame * const frame,
-        AVCodecContext * const codecContext) {
+void VideoFrameLoader::setFrameToConvert(AVFrame * const frame) {
     cleanUp();
     mFrameToConvert = frame;
-    mSwsContext = sws_getContext(codecContext->width,
-                                 codecContext->height,
-                                 codecContext->pix_fmt,
-                                 codecContext->width,
-                                 codecContext->height,
-                                 AV_PIX_FMT_RGBA, SWS_BICUBIC,
-                                 nullptr, nullptr, nullptr);
 }
 
 void VideoFrameLoader::process() {
     if(mFrameToConvert) {
-        convertFrame();
+        convertFrames();
     } else {
         readFrame();
     }
@@ -282,8 +410,4 @@ void VideoFrameLoader::cleanUp() {
         av_frame_free(&mFrameToConvert);
         mFrameToConvert = nullptr;
     }
-    if(mSwsContext) {
-        sws_freeContext(mSwsContext);
-        mSwsContext = nullptr;
-    }
 }
@@ -28,6 +28,7 @@
 #include "Tasks/updatable.h"
 #include "skia/skiaincludes.h"
 #include "videocachehandler.h"
+#include "videostreamspool.h"
 extern "C" {
     #include <libavutil/opt.h>
     #include <libavcodec/avcodec.h>
@@ -37,19 +38,23 @@ extern "C" {
     #include <libavutil/imgutils.h>
 }
 
-struct VideoStreamsData;
 class CORE_EXPORT VideoFrameLoader : public eHddTask {
     e_OBJECT
 protected:
     VideoFrameLoader(VideoFrameHandler * const cacheHandler,
-                     const stdsptr<VideoStreamsData>& openedVideo,
-                     const int frameId);
+                     const stdsptr<VideoStreamsPool>& streams,
+                     const int frameId, const int downscale);
     VideoFrameLoader(VideoFrameHandler * const cacheHandler,
-                     const stdsptr<VideoStreamsData>& openedVideo,
-                     const int frameId, AVFrame* const frame);
+                     const stdsptr<VideoStreamsPool>& streams,
+                     const int frameId, const int downscale,
+                     AVFrame* const frame);
 public:
     ~VideoFrameLoader();
 
+    //! @brief Keeps decoding the count frames following mFrameId
+    void setReadAhead(const int count) { mReadAhead = count; }
+    int readAhead() const { return mReadAhead; }
+
     void process();
     bool nextStep();
 protected:
@@ -60,21 +65,31 @@ protected:
     void queTaskNow();
 private:
     void cleanUp();
-    void setupSwsContext(AVCodecContext * const codecContext);
+    void unreserve();
     void readFrame();
-    void setFrameToConvert(AVFrame * const frame,
-                           AVCodecContext * const codecContext);
-    void convertFrame();
+    void readFrame(VideoStreamsData * const openedVideo);
+    void readAheadFrames(VideoStreamsData * const openedVideo);
+    void setFrameToConvert(AVFrame * const frame);
+    void convertFrames();
+    VideoFrameData convertFrame(AVFrame * const frame);
+    void releaseReadAhead(const bool finished);
 
     const qptr<VideoFrameHandler> mCacheHandler;
-    const stdsptr<VideoStreamsData> mOpenedVideo;
+    const stdsptr<VideoStreamsPool> mStreams;
+    //! @brief Holds a pool reservation to decode on a cpu thread
+    bool mReserved = false;
     const int mFrameId;
-    sk_sp<SkImage> mLoadedFrame;
+    //! @brief Frames are scaled to 1/mDownscale of the source size
+    const int mDownscale;
+    VideoFrameData mLoadedFrame;
 
     QList<std::pair<int, AVFrame*>> mExcessFrames;
 
+    int mReadAhead = 0;
+    QList<std::pair<int, AVFrame*>> mReadAheadFrames;
+    QMap<int, VideoFrameData> mReadAheadImages;
+
     AVFrame * mFrameToConvert = nullptr;
-    struct SwsContext * mSwsContext = nullptr;
 };
 
 #endif // VIDEOFRAMELOADER_H
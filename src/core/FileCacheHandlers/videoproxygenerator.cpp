@@ -0,0 +1,284 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "videoproxygenerator.h"
+#include "appsupport.h"
+#include "animationcachehandler.h"
+
+#include <QFileInfo>
+#include <QPointer>
+#include <QFile>
+
+extern "C" {
+    #include <libavutil/imgutils.h>
+}
+
+class VideoProxyTranscoder {
+public:
+    VideoProxyTranscoder(const QString& srcPath, const QString& dstPath);
+    ~VideoProxyTranscoder();
+
+    //! @brief Returns true once the whole video has been written
+    bool transcode(const int maxFrames);
+
+    int frameCount() const { return mSrc->fFrameCount; }
+    int framesDone() const { return mFramesDone; }
+private:
+    void openOutput();
+    void closeOutput();
+    int drainDecoder();
+    void writeFrame(AVFrame * const frame);
+    void encode(AVFrame * const frame);
+    void finish();
+
+    const QString mDstPath;
+    const QString mTmpPath;
+    const stdsptr<VideoStreamsData> mSrc;
+
+    AVFormatContext * mFormatContext = nullptr;
+    AVCodecContext * mCodecContext = nullptr;
+    AVStream * mStream = nullptr;
+    AVFrame * mDstFrame = nullptr;
+    AVPacket * mPacket = nullptr;
+    struct SwsContext * mSwsContext = nullptr;
+
+    int64_t mLastPts = AV_NOPTS_VALUE;
+    int mFramesDone = 0;
+    bool mFinished = false;
+};
+
+VideoProxyTranscoder::VideoProxyTranscoder(const QString& srcPath,
+                                           const QString& dstPath) :
+    mDstPath(dstPath), mTmpPath(dstPath + ".part"),
+    mSrc(VideoStreamsData::sOpen(srcPath, false)) {}
+
+VideoProxyTranscoder::~VideoProxyTranscoder() {
+    closeOutput();
+    if(!mFinished) QFile::remove(mTmpPath);
+}
+
+void VideoProxyTranscoder::openOutput() {
+    const auto srcCodec = mSrc->fCodecContext;
+    const int downscale = VideoProxyGenerator::sProxyDownscale(srcCodec->width);
+    const int width = AnimationFrameHandler::sDownscaledSize(
+                srcCodec->width, downscale);
+    const int height = AnimationFrameHandler::sDownscaledSize(
+                srcCodec->height, downscale);
+
+    const auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if(!codec) RuntimeThrow("MJPEG encoder not available");
+
+    const auto tmpPath = mTmpPath.toStdString();
+    avformat_alloc_output_context2(&mFormatContext, nullptr,
+                                   "matroska", tmpPath.c_str());
+    if(!mFormatContext) RuntimeThrow("Could not allocate output context");
+
+    mStream = avformat_new_stream(mFormatContext, nullptr);
+    if(!mStream) RuntimeThrow("Could not alloc stream");
+
+    mCodecContext = avcodec_alloc_context3(codec);
+    if(!mCodecContext) RuntimeThrow("Could not alloc an encoding context");
+    mCodecContext->width = width;
+    mCodecContext->height = height;
+    mCodecContext->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    mCodecContext->time_base = mSrc->fVideoStream->time_base;
+    mCodecContext->framerate = mSrc->fVideoStream->avg_frame_rate;
+    mCodecContext->flags |= AV_CODEC_FLAG_QSCALE;
+    mCodecContext->global_quality = FF_QP2LAMBDA*4;
+    if(mFormatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+        mCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if(avcodec_open2(mCodecContext, codec, nullptr) < 0)
+        RuntimeThrow("Could not open MJPEG encoder");
+    if(avcodec_parameters_from_context(mStream->codecpar, mCodecContext) < 0)
+        RuntimeThrow("Could not copy the stream parameters");
+    mStream->time_base = mCodecContext->time_base;
+
+    if(avio_open(&mFormatContext->pb, tmpPath.c_str(), AVIO_FLAG_WRITE) < 0)
+        RuntimeThrow("Could not open '" + tmpPath + "'");
+    if(avformat_write_header(mFormatContext, nullptr) < 0)
+        RuntimeThrow("Could not write proxy header");
+
+    mDstFrame = av_frame_alloc();
+    if(!mDstFrame) RuntimeThrow("Could not allocate frame");
+    mDstFrame->format = mCodecContext->pix_fmt;
+    mDstFrame->width = width;
+    mDstFrame->height = height;
+    if(av_frame_get_buffer(mDstFrame, 32) < 0)
+        RuntimeThrow("Could not allocate frame data");
+
+    mPacket = av_packet_alloc();
+    if(!mPacket) RuntimeThrow("Error allocating AVPacket");
+}
+
+void VideoProxyTranscoder::closeOutput() {
+    if(mSwsContext) sws_freeContext(mSwsContext);
+    mSwsContext = nullptr;
+    if(mPacket) av_packet_free(&mPacket);
+    if(mDstFrame) av_frame_free(&mDstFrame);
+    if(mCodecContext) avcodec_free_context(&mCodecContext);
+    if(mFormatContext) {
+        if(mFormatContext->pb) avio_closep(&mFormatContext->pb);
+        avformat_free_context(mFormatContext);
+        mFormatContext = nullptr;
+    }
+    mStream = nullptr;
+}
+
+bool VideoProxyTranscoder::transcode(const int maxFrames) {
+    if(mFinished) return true;
+    if(!mFormatContext) openOutput();
+    const auto formatContext = mSrc->fFormatContext;
+    const auto codecContext = mSrc->fCodecContext;
+    const auto packet = mSrc->fPacket;
+    int frames = 0;
+    while(frames < maxFrames) {
+        const int readRet = av_read_frame(formatContext, packet);
+        if(readRet < 0) {
+            avcodec_send_packet(codecContext, nullptr);
+            drainDecoder();
+            finish();
+            return true;
+        }
+        if(packet->stream_index != mSrc->fVideoStreamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        const int sendRet = avcodec_send_packet(codecContext, packet);
+        av_packet_unref(packet);
+        if(sendRet < 0) RuntimeThrow("Sending packet to the decoder failed");
+        frames += drainDecoder();
+    }
+    return false;
+}
+
+int VideoProxyTranscoder::drainDecoder() {
+    const auto codecContext = mSrc->fCodecContext;
+    const auto decodedFrame = mSrc->fDecodedFrame;
+    int frames = 0;
+    while(true) {
+        const int recRet = avcodec_receive_frame(codecContext, decodedFrame);
+        if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) break;
+        if(recRet < 0) RuntimeThrow("Did not receive frame from the decoder");
+        writeFrame(decodedFrame);
+        av_frame_unref(decodedFrame);
+        frames++;
+    }
+    mFramesDone += frames;
+    return frames;
+}
+
+void VideoProxyTranscoder::writeFrame(AVFrame * const frame) {
+    mSwsContext = sws_getCachedContext(
+                mSwsContext, frame->width, frame->height,
+                static_cast<AVPixelFormat>(frame->format),
+                mDstFrame->width, mDstFrame->height,
+                mCodecContext->pix_fmt, SWS_BILINEAR,
+                nullptr, nullptr, nullptr);
+    if(!mSwsContext) RuntimeThrow("Cannot initialize the conversion context");
+    if(av_frame_make_writable(mDstFrame) < 0)
+        RuntimeThrow("Could not make AVFrame writable");
+    sws_scale(mSwsContext, frame->data, frame->linesize, 0, frame->height,
+              mDstFrame->data, mDstFrame->linesize);
+
+    // keep source timestamps, so frames map to the same ids as the original
+    int64_t pts = frame->best_effort_timestamp;
+    if(pts == AV_NOPTS_VALUE) {
+        pts = mLastPts == AV_NOPTS_VALUE ? 0 : mLastPts + 1;
+    } else if(mLastPts != AV_NOPTS_VALUE && pts <= mLastPts) {
+        pts = mLastPts + 1;
+    }
+    mLastPts = pts;
+    mDstFrame->pts = pts;
+    mDstFrame->quality = mCodecContext->global_quality;
+    encode(mDstFrame);
+}
+
+void VideoProxyTranscoder::encode(AVFrame * const frame) {
+    if(avcodec_send_frame(mCodecContext, frame) < 0)
+        RuntimeThrow("Error submitting a frame for encoding");
+    while(true) {
+        const int recRet = avcodec_receive_packet(mCodecContext, mPacket);
+        if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) break;
+        if(recRet < 0) RuntimeThrow("Error encoding a proxy frame");
+        av_packet_rescale_ts(mPacket, mCodecContext->time_base,
+                             mStream->time_base);
+        mPacket->stream_index = mStream->index;
+        const int writeRet = av_interleaved_write_frame(mFormatContext,
+                                                        mPacket);
+        if(writeRet < 0) RuntimeThrow("Error while writing proxy frame");
+    }
+}
+
+void VideoProxyTranscoder::finish() {
+    encode(nullptr);
+    if(av_write_trailer(mFormatContext) < 0)
+        RuntimeThrow("Could not write proxy trailer");
+    closeOutput();
+    QFile::remove(mDstPath);
+    if(!QFile::rename(mTmpPath, mDstPath))
+        RuntimeThrow("Could not move proxy to '" + mDstPath.toStdString() + "'");
+    mFinished = true;
+}
+
+VideoProxyGenerator::VideoProxyGenerator(const QString& srcPath,
+                                         const QString& proxyPath) :
+    VideoProxyGenerator(srcPath, proxyPath,
+                        std::make_shared<VideoProxyTranscoder>(srcPath,
+                                                               proxyPath)) {}
+
+VideoProxyGenerator::VideoProxyGenerator(
+        const QString& srcPath, const QString& proxyPath,
+        const stdsptr<VideoProxyTranscoder>& transcoder) :
+    ComplexTask(qMax(1, transcoder->frameCount()),
+                QObject::tr("Video Proxy %1").arg(QFileInfo(srcPath).fileName())),
+    mProxyPath(proxyPath), mTranscoder(transcoder) {}
+
+void VideoProxyGenerator::nextStep() {
+    if(done()) return;
+    const auto transcoder = mTranscoder;
+    if(setValue(qMin(transcoder->framesDone(), finishValue() - 1))) return;
+    const auto finished = std::make_shared<bool>(false);
+    const auto run = [transcoder, finished]() {
+        *finished = transcoder->transcode(25);
+    };
+    const QPointer<VideoProxyGenerator> ptr = this;
+    const auto after = [ptr, finished]() {
+        if(ptr && *finished) ptr->finish();
+    };
+    const auto task = enve::make_shared<eCustomCpuTask>(
+                nullptr, run, after, nullptr);
+    task->queTask();
+    addTask(task);
+}
+
+QString VideoProxyGenerator::sProxyPath(const QString& srcPath) {
+    const QString name = AppSupport::getFileCacheKey(srcPath);
+    return QString("%1/%2.mkv").arg(AppSupport::getAppProxyPath(), name);
+}
+
+int VideoProxyGenerator::sProxyDownscale(const int width) {
+    int downscale = 2;
+    while(downscale < 8 && width/downscale > 960) downscale *= 2;
+    return downscale;
+}
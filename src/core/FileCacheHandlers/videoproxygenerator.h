@@ -0,0 +1,57 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef VIDEOPROXYGENERATOR_H
+#define VIDEOPROXYGENERATOR_H
+
+#include "Private/Tasks/complextask.h"
+#include "videostreamsdata.h"
+
+class VideoProxyTranscoder;
+
+//! @brief Transcodes a video to a reduced size, intra-only (MJPEG)
+//! proxy in background CPU tasks, a chunk of frames at a time.
+class CORE_EXPORT VideoProxyGenerator : public ComplexTask {
+public:
+    VideoProxyGenerator(const QString& srcPath,
+                        const QString& proxyPath);
+
+    void nextStep();
+
+    const QString& proxyPath() const { return mProxyPath; }
+
+    //! @brief Proxy file in the cache folder, unique per source file
+    //! path, size and modification time
+    static QString sProxyPath(const QString& srcPath);
+    //! @brief Downscale of proxies for a source of the given width
+    static int sProxyDownscale(const int width);
+private:
+    VideoProxyGenerator(const QString& srcPath,
+                        const QString& proxyPath,
+                        const stdsptr<VideoProxyTranscoder>& transcoder);
+
+    const QString mProxyPath;
+    const stdsptr<VideoProxyTranscoder> mTranscoder;
+};
+
+#endif // VIDEOPROXYGENERATOR_H
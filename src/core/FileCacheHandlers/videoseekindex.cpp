@@ -0,0 +1,183 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "videoseekindex.h"
+#include "videostreamsdata.h"
+#include "appsupport.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QtMath>
+
+#include <algorithm>
+
+static const quint32 sIndexMagic = 0x46565349;
+static const qint32 sIndexVersion = 1;
+
+VideoSeekIndex::VideoSeekIndex(const qreal fps, const AVRational& timeBase,
+                               const QVector<qint64>& framePts,
+                               const QVector<qint64>& keyPts) :
+    mFps(fps), mTimeBase(timeBase),
+    mFramePts(framePts), mKeyPts(keyPts) {}
+
+int VideoSeekIndex::sFrameId(const int64_t pts, const AVRational& timeBase,
+                             const qreal fps) {
+    const int64_t us = av_rescale_q(pts, timeBase, {1, AV_TIME_BASE});
+    const qreal frameApprox = us/1000000.*fps;
+    const int frameRound = qRound(frameApprox);
+    if(frameRound - frameApprox > 0.4) return frameRound - 1;
+    return frameRound;
+}
+
+int VideoSeekIndex::frameId(const int64_t pts) const {
+    return sFrameId(pts, mTimeBase, mFps);
+}
+
+int64_t VideoSeekIndex::keyframePts(const int frameId) const {
+    // first frame shown at or after frameId
+    const auto frameIt = std::lower_bound(
+                mFramePts.begin(), mFramePts.end(), frameId,
+                [this](const qint64 pts, const int id) {
+        return this->frameId(pts) < id;
+    });
+    if(frameIt == mFramePts.end()) return mKeyPts.last();
+    const auto keyIt = std::upper_bound(mKeyPts.begin(), mKeyPts.end(),
+                                        *frameIt);
+    if(keyIt == mKeyPts.begin()) return mKeyPts.first();
+    return *(keyIt - 1);
+}
+
+int VideoSeekIndex::keyframeId(const int frameId) const {
+    return this->frameId(keyframePts(frameId));
+}
+
+QString VideoSeekIndex::sIndexPath(const QString& srcPath) {
+    const QString name = AppSupport::getFileCacheKey(srcPath);
+    return QString("%1/%2.idx").arg(AppSupport::getAppSeekIndexPath(), name);
+}
+
+stdsptr<const VideoSeekIndex> VideoSeekIndex::sLoadOrBuild(
+        const QString& srcPath, const std::atomic<bool>* const abort) {
+    const QString indexPath = sIndexPath(srcPath);
+    const auto cached = sRead(indexPath);
+    if(cached) return cached;
+    try {
+        const auto built = sBuild(srcPath, abort);
+        if(built && !built->write(indexPath))
+            qWarning() << "Could not write seek index" << indexPath;
+        return built;
+    } catch(const std::exception& e) {
+        qWarning() << "Could not index" << srcPath << e.what();
+        return nullptr;
+    }
+}
+
+stdsptr<VideoSeekIndex> VideoSeekIndex::sBuild(
+        const QString& srcPath, const std::atomic<bool>* const abort) {
+    const auto video = VideoStreamsData::sOpen(srcPath, false);
+    const auto formatContext = video->fFormatContext;
+    const auto packet = video->fPacket;
+    QVector<qint64> framePts;
+    QVector<qint64> keyPts;
+    // packets only, nothing gets decoded
+    while(av_read_frame(formatContext, packet) >= 0) {
+        if(abort && *abort) {
+            av_packet_unref(packet);
+            return nullptr;
+        }
+        if(packet->stream_index == video->fVideoStreamIndex) {
+            const int64_t pts = packet->pts != AV_NOPTS_VALUE ?
+                        packet->pts : packet->dts;
+            if(pts != AV_NOPTS_VALUE) {
+                framePts << pts;
+                if(packet->flags & AV_PKT_FLAG_KEY) keyPts << pts;
+            }
+        }
+        av_packet_unref(packet);
+    }
+    if(keyPts.isEmpty()) return nullptr;
+    std::sort(framePts.begin(), framePts.end());
+    std::sort(keyPts.begin(), keyPts.end());
+    const AVRational timeBase = video->fVideoStream->time_base;
+    return stdsptr<VideoSeekIndex>(
+                new VideoSeekIndex(video->fFps, timeBase, framePts, keyPts));
+}
+
+stdsptr<VideoSeekIndex> VideoSeekIndex::sRead(const QString& indexPath) {
+    QFile file(indexPath);
+    if(!file.open(QIODevice::ReadOnly)) return nullptr;
+    QDataStream src(&file);
+    quint32 magic;
+    qint32 version;
+    src >> magic >> version;
+    if(magic != sIndexMagic || version != sIndexVersion)
+        return nullptr;
+    double fps;
+    qint32 timeBaseNum;
+    qint32 timeBaseDen;
+    QVector<qint64> framePts;
+    QVector<qint64> keyPts;
+    src >> fps >> timeBaseNum >> timeBaseDen >> framePts >> keyPts;
+    if(src.status() != QDataStream::Ok || keyPts.isEmpty()) return nullptr;
+    const AVRational timeBase{timeBaseNum, timeBaseDen};
+    return stdsptr<VideoSeekIndex>(
+                new VideoSeekIndex(fps, timeBase, framePts, keyPts));
+}
+
+bool VideoSeekIndex::write(const QString& indexPath) const {
+    const QString tmpPath = indexPath + ".part";
+    {
+        QFile file(tmpPath);
+        if(!file.open(QIODevice::WriteOnly)) return false;
+        QDataStream dst(&file);
+        dst << sIndexMagic << sIndexVersion;
+        dst << double(mFps) << qint32(mTimeBase.num) << qint32(mTimeBase.den);
+        dst << mFramePts << mKeyPts;
+        if(dst.status() != QDataStream::Ok) {
+            file.remove();
+            return false;
+        }
+    }
+    QFile::remove(indexPath);
+    return QFile::rename(tmpPath, indexPath);
+}
+
+void VideoSeekIndexLoader::process() {
+    mIndex = VideoSeekIndex::sLoadOrBuild(mSrcPath, &mAbort);
+}
+
+void VideoSeekIndexLoader::afterProcessing() {
+    if(mAbort || !mFinished) return;
+    mFinished(mIndex);
+}
+
+void VideoSeekIndexLoader::afterCanceled() {
+    if(mAbort || !mFinished) return;
+    mFinished(nullptr);
+}
+
+void VideoSeekIndexLoader::abort() {
+    mAbort = true;
+    cancel();
+}
@@ -0,0 +1,107 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef VIDEOSEEKINDEX_H
+#define VIDEOSEEKINDEX_H
+
+#include "smartPointers/stdselfref.h"
+#include "Tasks/updatable.h"
+
+#include <QVector>
+
+#include <atomic>
+
+extern "C" {
+    #include <libavformat/avformat.h>
+}
+
+//! @brief Timestamps of every frame and keyframe of a video stream, so
+//! that decoding of a frame starts at exactly the keyframe it needs,
+//! also for variable frame rate files. Built by demuxing the file once,
+//! without decoding, and cached on disk.
+class CORE_EXPORT VideoSeekIndex {
+public:
+    //! @brief Cached index of srcPath, built and cached if missing,
+    //! nullptr if it cannot be built or abort got set while building
+    static stdsptr<const VideoSeekIndex> sLoadOrBuild(
+            const QString& srcPath,
+            const std::atomic<bool>* const abort = nullptr);
+    //! @brief Index file in the cache folder, unique per source file
+    //! path, size and modification time
+    static QString sIndexPath(const QString& srcPath);
+
+    //! @brief Frame id of a timestamp, as used by the frame loaders
+    static int sFrameId(const int64_t pts, const AVRational& timeBase,
+                        const qreal fps);
+
+    //! @brief Timestamp of the keyframe decoding of frameId starts from
+    int64_t keyframePts(const int frameId) const;
+    int keyframeId(const int frameId) const;
+private:
+    VideoSeekIndex(const qreal fps, const AVRational& timeBase,
+                   const QVector<qint64>& framePts,
+                   const QVector<qint64>& keyPts);
+
+    static stdsptr<VideoSeekIndex> sBuild(const QString& srcPath,
+                                          const std::atomic<bool>* const abort);
+    static stdsptr<VideoSeekIndex> sRead(const QString& indexPath);
+    bool write(const QString& indexPath) const;
+
+    int frameId(const int64_t pts) const;
+
+    const qreal mFps;
+    const AVRational mTimeBase;
+    //! @brief Sorted presentation timestamps of all frames
+    const QVector<qint64> mFramePts;
+    //! @brief Sorted presentation timestamps of the keyframes
+    const QVector<qint64> mKeyPts;
+};
+
+//! @brief Loads or builds the seek index of a file on the HDD queue,
+//! abort() stops the demux of a build that is already running
+class CORE_EXPORT VideoSeekIndexLoader : public eHddTask {
+    e_OBJECT
+public:
+    using Finished = std::function<void(const stdsptr<const VideoSeekIndex>&)>;
+protected:
+    VideoSeekIndexLoader(const QString& srcPath, const Finished& finished) :
+        mSrcPath(srcPath), mFinished(finished) {}
+
+    void afterProcessing() final;
+    void afterCanceled() final;
+public:
+    void beforeProcessing(const Hardware) final {}
+    void process() final;
+
+    const QString& srcPath() const { return mSrcPath; }
+    //! @brief Cancels the task, finished does not get called,
+    //! other cancels call it with nullptr
+    void abort();
+private:
+    const QString mSrcPath;
+    const Finished mFinished;
+    std::atomic<bool> mAbort{false};
+    stdsptr<const VideoSeekIndex> mIndex;
+};
+
+#endif // VIDEOSEEKINDEX_H
@@ -26,18 +26,19 @@
 #include "videostreamsdata.h"
 #include "Private/esettings.h"
 
-stdsptr<VideoStreamsData> VideoStreamsData::sOpen(const QString &path) {
+stdsptr<VideoStreamsData> VideoStreamsData::sOpen(const QString &path,
+                                                  const bool openAudio) {
     const auto result = std::shared_ptr<VideoStreamsData>(
                 new VideoStreamsData, VideoStreamsData::sDestroy);
-    result->open(path);
+    result->open(path, openAudio);
     return result;
 }
 
 
-void VideoStreamsData::open(const QString &path) {
+void VideoStreamsData::open(const QString &path, const bool openAudio) {
     try {
         fPath = path;
-        open();
+        open(openAudio);
     } catch(...) {
         fPath.clear();
         RuntimeThrow("Failed to set video file path to '" + path + "'.");
@@ -49,8 +50,6 @@ void VideoStreamsData::close() {
 
     if(fDecodedFrame) av_frame_free(&fDecodedFrame);
     if(fPacket) av_packet_free(&fPacket);
-    if(fSwsContext) sws_freeContext(fSwsContext);
-    fSwsContext = nullptr;
     if(fCodecContext) {
         avcodec_close(fCodecContext);
         avcodec_free_context(&fCodecContext);
@@ -61,18 +60,19 @@ void VideoStreamsData::close() {
     fVideoStream = nullptr;
 }
 
-void VideoStreamsData::open() {
+void VideoStreamsData::open(const bool openAudio) {
     const auto stdString = fPath.toStdString();
     const char * const path = stdString.c_str();
     try {
-        open(path);
+        open(path, openAudio);
     } catch(...) {
         close();
         RuntimeThrow("Failed to setup video stream for '" + path + "'.");
     }
 }
 
-void VideoStreamsData::open(const char * const path)
+void VideoStreamsData::open(const char * const path,
+                            const bool openAudio)
 {
     fFormatContext = avformat_alloc_context();
     if (!fFormatContext) {
@@ -151,14 +151,8 @@ void VideoStreamsData::open(const char * const path)
     }
     fWidth = fCodecContext->width;
     fHeight = fCodecContext->height;
-    fSwsContext = sws_getContext(fCodecContext->width,
-                                 fCodecContext->height,
-                                 fCodecContext->pix_fmt,
-                                 fCodecContext->width,
-                                 fCodecContext->height,
-                                 AV_PIX_FMT_RGBA, SWS_BICUBIC,
-                                 nullptr, nullptr, nullptr);
-
+    fSrcWidth = fWidth;
+    fSrcHeight = fHeight;
     fPacket = av_packet_alloc();
     if (!fPacket) {
         RuntimeThrow(QObject::tr("Error allocating AVPacket"));
@@ -170,5 +164,5 @@ void VideoStreamsData::open(const char * const path)
 
     fOpened = true;
 
-    if (hasAudio) { fAudioData = AudioStreamsData::sOpen(fPath); }
+    if (hasAudio && openAudio) { fAudioData = AudioStreamsData::sOpen(fPath); }
 }
@@ -51,18 +51,24 @@ public:
     AVPacket * fPacket = nullptr;
     AVFrame *fDecodedFrame = nullptr;
     AVCodecContext * fCodecContext = nullptr;
-    struct SwsContext * fSwsContext = nullptr;
     int fLastFrame = 0;
     int fWidth = 0;
     int fHeight = 0;
+    //! @brief Size of the stream relative to the original, e.g., 4 for
+    //! proxies at a quarter of the source size
+    int fDownscale = 1;
+    //! @brief Size of the original, reduced frames get sized from it
+    int fSrcWidth = 0;
+    int fSrcHeight = 0;
 
     stdsptr<const AudioStreamsData> fAudioData;
 
-    static stdsptr<VideoStreamsData> sOpen(const QString& path);
+    static stdsptr<VideoStreamsData> sOpen(const QString& path,
+                                           const bool openAudio = true);
 private:
-    void open(const QString& path);
-    void open();
-    void open(const char * const path);
+    void open(const QString& path, const bool openAudio);
+    void open(const bool openAudio);
+    void open(const char * const path, const bool openAudio);
     void close();
 };
 #endif // VIDEOSTREAMSDATA_H
@@ -0,0 +1,134 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "videostreamspool.h"
+#include "Private/esettings.h"
+
+#include <QDebug>
+#include <QtMath>
+
+static int maxContexts(const VideoStreamsData& primary) {
+    // decoders keep about a frame per thread along with the references
+    const auto codecContext = primary.fCodecContext;
+    const qint64 frameBytes = qint64(primary.fWidth)*primary.fHeight*3/2;
+    const qint64 contextBytes = frameBytes*(codecContext->thread_count + 16);
+    const qint64 budget = qint64(eSettings::sRamMBCap().fValue)*1024*1024/16;
+    const int maxCount = qMin(4, eSettings::sCpuThreadsCapped());
+    return qBound(1, static_cast<int>(budget/qMax(qint64(1), contextBytes)),
+                  qMax(1, maxCount));
+}
+
+VideoStreamsPool::VideoStreamsPool(const stdsptr<VideoStreamsData>& primary) :
+    mPrimary(primary), mMaxCount(maxContexts(*primary)) {
+    mIdle << primary;
+}
+
+bool VideoStreamsPool::reserve() {
+    QMutexLocker lock(&mMutex);
+    // one context is always left for the hdd thread
+    if(mReserved >= mMaxCount - 1) return false;
+    mReserved++;
+    return true;
+}
+
+void VideoStreamsPool::unreserve() {
+    QMutexLocker lock(&mMutex);
+    mReserved--;
+}
+
+void VideoStreamsPool::setSeekIndex(
+        const stdsptr<const VideoSeekIndex>& index) {
+    QMutexLocker lock(&mMutex);
+    mSeekIndex = index;
+}
+
+stdsptr<const VideoSeekIndex> VideoStreamsPool::seekIndex() {
+    QMutexLocker lock(&mMutex);
+    return mSeekIndex;
+}
+
+int VideoStreamsPool::seekCost(const int frameId) const {
+    // decoding starts at the keyframe the seek lands on
+    if(mSeekIndex) return frameId - mSeekIndex->keyframeId(frameId) + 1;
+    return qCeil(mPrimary->fFps) + 1;
+}
+
+int VideoStreamsPool::decodeCost(const VideoStreamsData& streams,
+                                 const int frameId) const {
+    const int lastFrame = streams.fLastFrame;
+    if(lastFrame < frameId) {
+        const bool sameGop = mSeekIndex ?
+                    mSeekIndex->keyframeId(frameId) <= lastFrame :
+                    frameId - lastFrame <= mPrimary->fFps;
+        if(sameGop) return frameId - lastFrame;
+    }
+    return seekCost(frameId);
+}
+
+stdsptr<VideoStreamsData> VideoStreamsPool::openContext() {
+    try {
+        const auto result = VideoStreamsData::sOpen(mPrimary->fPath, false);
+        result->fDownscale = mPrimary->fDownscale;
+        result->fSrcWidth = mPrimary->fSrcWidth;
+        result->fSrcHeight = mPrimary->fSrcHeight;
+        return result;
+    } catch(const std::exception& e) {
+        qWarning() << "Could not open another decoder for" <<
+                      mPrimary->fPath << e.what();
+        return nullptr;
+    }
+}
+
+stdsptr<VideoStreamsData> VideoStreamsPool::acquire(const int frameId) {
+    QMutexLocker lock(&mMutex);
+    while(true) {
+        int bestId = -1;
+        int bestCost = INT_MAX;
+        for(int i = 0; i < mIdle.count(); i++) {
+            const int cost = decodeCost(*mIdle.at(i), frameId);
+            if(cost >= bestCost) continue;
+            bestCost = cost;
+            bestId = i;
+        }
+        // keep the positions of the idle contexts instead of seeking away
+        const bool grow = mCount < mMaxCount && !mGrowFailed;
+        if(grow && bestCost >= seekCost(frameId)) {
+            mCount++;
+            lock.unlock();
+            const auto opened = openContext();
+            if(opened) return opened;
+            lock.relock();
+            mCount--;
+            mGrowFailed = true;
+            continue;
+        }
+        if(bestId != -1) return mIdle.takeAt(bestId);
+        mReleased.wait(&mMutex);
+    }
+}
+
+void VideoStreamsPool::release(const stdsptr<VideoStreamsData>& streams) {
+    QMutexLocker lock(&mMutex);
+    mIdle << streams;
+    mReleased.wakeOne();
+}
@@ -0,0 +1,76 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef VIDEOSTREAMSPOOL_H
+#define VIDEOSTREAMSPOOL_H
+
+#include "videostreamsdata.h"
+#include "videoseekindex.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+
+//! @brief Independent demux/decode contexts of one video file, so that
+//! distant frames can be decoded in parallel without seeking back and
+//! forth in a single decoder. The pool size is bounded by memory.
+class CORE_EXPORT VideoStreamsPool {
+public:
+    explicit VideoStreamsPool(const stdsptr<VideoStreamsData>& primary);
+
+    //! @brief First opened context, describes the stream
+    const stdsptr<VideoStreamsData>& primary() const { return mPrimary; }
+    int downscale() const { return mPrimary->fDownscale; }
+    qreal fps() const { return mPrimary->fFps; }
+
+    //! @brief Reserves a context for decoding outside of the hdd thread,
+    //! returns false if the pool has none to spare
+    bool reserve();
+    void unreserve();
+
+    //! @brief Takes the idle context that reaches frameId with the least
+    //! decoding, opening a new one rather than seeking while allowed to grow
+    stdsptr<VideoStreamsData> acquire(const int frameId);
+    void release(const stdsptr<VideoStreamsData>& streams);
+
+    //! @brief Set once built, seeks are exact and costs GOP-aware with it
+    void setSeekIndex(const stdsptr<const VideoSeekIndex>& index);
+    stdsptr<const VideoSeekIndex> seekIndex();
+private:
+    int decodeCost(const VideoStreamsData& streams, const int frameId) const;
+    int seekCost(const int frameId) const;
+    stdsptr<VideoStreamsData> openContext();
+
+    const stdsptr<VideoStreamsData> mPrimary;
+    const int mMaxCount;
+
+    QMutex mMutex;
+    QWaitCondition mReleased;
+    QList<stdsptr<VideoStreamsData>> mIdle;
+    stdsptr<const VideoSeekIndex> mSeekIndex;
+    //! @brief Contexts opened or being opened
+    int mCount = 1;
+    int mReserved = 0;
+    bool mGrowFailed = false;
+};
+
+#endif // VIDEOSTREAMSPOOL_H
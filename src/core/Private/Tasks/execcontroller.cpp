@@ -87,3 +87,8 @@ HddExecController::HddExecController(QObject* const parent) :
     ExecController(new HddTaskExecutor, parent) {
     start();
 }
+
+EncodeExecController::EncodeExecController(QObject* const parent) :
+    ExecController(new EncodeTaskExecutor, parent) {
+    start();
+}
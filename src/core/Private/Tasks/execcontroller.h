@@ -65,4 +65,9 @@ public:
     HddExecController(QObject * const parent = nullptr);
 };
 
+class CORE_EXPORT EncodeExecController : public ExecController {
+public:
+    EncodeExecController(QObject * const parent = nullptr);
+};
+
 #endif // EXECCONTROLLER_H
@@ -31,7 +31,7 @@ QAtomicList<stdsptr<eTask>> GpuTaskExecutor::sTasks;
 QAtomicInt GpuTaskExecutor::sUseCount = 0;
 
 GpuTaskExecutor::GpuTaskExecutor() :
-    TaskExecutor(sUseCount, sTasks) {}
+    TaskExecutor(sUseCount, sTasks, RenderStats::Stage::gpu) {}
 
 void GpuTaskExecutor::sAddTask(const stdsptr<eTask>& ready) {
     sTasks.appendAndNotifyAll(ready);
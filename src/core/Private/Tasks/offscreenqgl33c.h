@@ -42,7 +42,8 @@ public:
         mContext->setShareContext(QOpenGLContext::globalShareContext());
         if(!mContext->create())
             PrettyRuntimeThrow("Creating OpenGL context failed.\n "
-                               "Make sure your GPU drivers support OpenGL 3.3 core.");
+                               "Make sure your GPU drivers support OpenGL 3.3 core, "
+                               "or use software OpenGL (--software-gl).");
     }
 
     void makeCurrent() {
@@ -65,6 +65,7 @@ void TaskExecutor::processLoop() {
         if(!mTasks.waitTakeFirst(task, mStop)) break;
         mUseCount++;
         try {
+            const RenderStats::Timer timer(mStage);
             processTask(*task);
         } catch(...) {
             task->setException(std::current_exception());
@@ -98,3 +99,18 @@ int HddTaskExecutor::sUsageCount() {
 int HddTaskExecutor::sWaitingTasks() {
     return sTasks.count();
 }
+
+QAtomicList<stdsptr<eTask>> EncodeTaskExecutor::sTasks;
+QAtomicInt EncodeTaskExecutor::sUseCount = 0;
+
+void EncodeTaskExecutor::sAddTask(const stdsptr<eTask>& ready) {
+    sTasks.appendAndNotifyAll(ready);
+}
+
+int EncodeTaskExecutor::sUsageCount() {
+    return sUseCount;
+}
+
+int EncodeTaskExecutor::sWaitingTasks() {
+    return sTasks.count();
+}
@@ -30,13 +30,15 @@
 
 #include "Tasks/updatable.h"
 #include "../qatomiclist.h"
+#include "renderstats.h"
 
 class CORE_EXPORT TaskExecutor : public QObject {
     Q_OBJECT
 public:
     TaskExecutor(QAtomicInt& count,
-                 QAtomicList<stdsptr<eTask>>& tasks) :
-        mUseCount(count), mTasks(tasks) {}
+                 QAtomicList<stdsptr<eTask>>& tasks,
+                 const RenderStats::Stage stage) :
+        mUseCount(count), mTasks(tasks), mStage(stage) {}
 
     static QAtomicInt sTaskFinishSignals;
 
@@ -53,11 +55,13 @@ private:
 
     QAtomicInt& mUseCount;
     QAtomicList<stdsptr<eTask>>& mTasks;
+    const RenderStats::Stage mStage;
 };
 
 class CORE_EXPORT CpuTaskExecutor : public TaskExecutor {
 public:
-    CpuTaskExecutor() : TaskExecutor(sUseCount, sTasks) {}
+    CpuTaskExecutor() : TaskExecutor(sUseCount, sTasks,
+                                     RenderStats::Stage::cpu) {}
 
     static void sAddTask(const stdsptr<eTask>& ready);
     static void sAddTasks(const QList<stdsptr<eTask>>& ready);
@@ -70,7 +74,8 @@ private:
 
 class CORE_EXPORT HddTaskExecutor : public TaskExecutor {
 public:
-    HddTaskExecutor() : TaskExecutor(sUseCount, sTasks) {}
+    HddTaskExecutor() : TaskExecutor(sUseCount, sTasks,
+                                     RenderStats::Stage::hddBusy) {}
 
     static void sAddTask(const stdsptr<eTask>& ready);
     static void sAddTasks(const QList<stdsptr<eTask>>& ready);
@@ -81,4 +86,17 @@ private:
     static QAtomicList<stdsptr<eTask>> sTasks;
 };
 
+class CORE_EXPORT EncodeTaskExecutor : public TaskExecutor {
+public:
+    EncodeTaskExecutor() : TaskExecutor(sUseCount, sTasks,
+                                        RenderStats::Stage::encoding) {}
+
+    static void sAddTask(const stdsptr<eTask>& ready);
+    static int sUsageCount();
+    static int sWaitingTasks();
+private:
+    static QAtomicInt sUseCount;
+    static QAtomicList<stdsptr<eTask>> sTasks;
+};
+
 #endif // TASKEXECUTOR_H
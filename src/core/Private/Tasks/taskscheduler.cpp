@@ -52,6 +52,10 @@ TaskScheduler::TaskScheduler() {
     connect(mHddExec.get(), &ExecController::finishedTaskSignal,
             this, &TaskScheduler::afterHddTaskFinished);
 
+    mEncodeExec = std::make_shared<EncodeExecController>(this);
+    connect(mEncodeExec.get(), &ExecController::finishedTaskSignal,
+            this, &TaskScheduler::afterEncodeTaskFinished);
+
     mGpuExec = std::make_shared<GpuExecController>(this);
     connect(mGpuExec.get(), &ExecController::finishedTaskSignal,
             this, &TaskScheduler::afterCpuGpuTaskFinished);
@@ -62,6 +66,7 @@ TaskScheduler::~TaskScheduler() {
         exec->stopAndWait();
     }
     mHddExec->stopAndWait();
+    mEncodeExec->stopAndWait();
     mGpuExec->stopAndWait();
 }
 
@@ -103,6 +108,13 @@ void TaskScheduler::queHddTask(const stdsptr<eTask>& task) {
     processNextQuedHddTask();
 }
 
+void TaskScheduler::queEncodeTask(const stdsptr<eTask>& task) {
+    // not qued behind file loads, nor held back in critical memory state,
+    // encoding is what releases rendered frames
+    task->aboutToProcess(Hardware::hdd);
+    EncodeTaskExecutor::sAddTask(task);
+}
+
 void TaskScheduler::queCpuTask(const stdsptr<eTask>& task) {
     mQuedCGTasks.addTask(task);
     if(task->readyToBeProcessed()) {
@@ -233,6 +245,13 @@ void TaskScheduler::afterCpuGpuTaskFinished(const stdsptr<eTask>& task) {
     callAllTasksFinishedFunc();
 }
 
+void TaskScheduler::afterEncodeTaskFinished(const stdsptr<eTask>& task) {
+    TaskExecutor::sTaskFinishSignals--;
+    task->finishedProcessing();
+    processNextTasks();
+    callAllTasksFinishedFunc();
+}
+
 void TaskScheduler::setTaskUnderflowFunc(const Func& func) {
     mTaskUnderflowFunc = func;
 }
@@ -245,6 +264,7 @@ bool TaskScheduler::allQuedTasksFinished() const {
     return allQuedCpuTasksFinished() &&
            allQuedHddTasksFinished() &&
            allQuedGpuTasksFinished() &&
+           !encodeTaskBeingProcessed() &&
            TaskExecutor::sTaskFinishSignals == 0;
 }
 
@@ -268,6 +288,11 @@ bool TaskScheduler::hddTaskBeingProcessed() const {
     return busyHddThreads() > 0;
 }
 
+bool TaskScheduler::encodeTaskBeingProcessed() const {
+    return EncodeTaskExecutor::sUsageCount() > 0 ||
+           EncodeTaskExecutor::sWaitingTasks() > 0;
+}
+
 int TaskScheduler::busyHddThreads() const {
     return HddTaskExecutor::sUsageCount();
 }
@@ -35,6 +35,7 @@
 class Canvas;
 class CpuExecController;
 class HddExecController;
+class EncodeExecController;
 class GpuExecController;
 class ComplexTask;
 
@@ -61,11 +62,14 @@ public:
     void queTasks();
     void queHddTask(const stdsptr<eTask>& task);
     void queCpuTask(const stdsptr<eTask> &task);
+    //! @brief Output encoding has a thread of its own, see VideoEncoder
+    void queEncodeTask(const stdsptr<eTask>& task);
 
     void clearTasks();
 
     void afterHddTaskFinished(const stdsptr<eTask>& finishedTask);
     void afterCpuGpuTaskFinished(const stdsptr<eTask>& task);
+    void afterEncodeTaskFinished(const stdsptr<eTask>& task);
 
     void setTaskUnderflowFunc(const Func& func);
     void setAllTasksFinishedFunc(const Func& func);
@@ -78,6 +82,7 @@ public:
 
     bool cpuTasksBeingProcessed() const;
     bool hddTaskBeingProcessed() const;
+    bool encodeTaskBeingProcessed() const;
 
     int busyHddThreads() const;
     int busyCpuThreads() const;
@@ -127,6 +132,7 @@ private:
     QList<stdsptr<CpuExecController>> mCpuExecs;
     stdsptr<GpuExecController> mGpuExec;
     stdsptr<HddExecController> mHddExec;
+    stdsptr<EncodeExecController> mEncodeExec;
 
     Func mTaskUnderflowFunc;
     Func mAllTasksFinishedFunc;
@@ -254,6 +254,14 @@ eSettings::eSettings(const int cpuThreads,
     gSettings << std::make_shared<eBoolSetting>(fPreviewCache,
                                                 "PreviewCache",
                                                 true);
+
+    gSettings << std::make_shared<eBoolSetting>(fVideoProxies,
+                                                "VideoProxies",
+                                                false);
+
+    gSettings << std::make_shared<eIntSetting>(fImageSequenceReadAhead,
+                                               "ImageSequenceReadAhead",
+                                               8);
     /*gSettings << std::make_shared<eBoolSetting>(
                      fTimelineAlternateRow,
                      "timelineAlternateRow", true);
@@ -41,6 +41,7 @@ enum class GpuVendor {
     intel,
     amd,
     nvidia,
+    software,
     unrecognized
 };
 
@@ -146,6 +147,12 @@ public:
 
     bool fPreviewCache = true;
 
+    // generate preview proxies for imported video
+    bool fVideoProxies = false;
+
+    // frames loaded ahead of playback in image sequences
+    int fImageSequenceReadAhead = 8;
+
     // timeline settings
     bool fTimelineAlternateRow = true;
     QColor fTimelineAlternateRowColor = QColor(0, 0, 0, 25);
@@ -36,6 +36,8 @@ class CORE_EXPORT MotionBlurEffect : public RasterEffect {
 public:
     FrameRange prp_getIdenticalRelRange(const int relFrame) const;
 
+    bool cacheableResult() const { return false; }
+
     stdsptr<RasterEffectCaller> getEffectCaller(
             const qreal relFrame, const qreal resolution,
             const qreal influence, BoxRenderData* const data) const;
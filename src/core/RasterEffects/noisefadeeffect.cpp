@@ -31,6 +31,9 @@
 
 #include "appsupport.h"
 
+#include <QMutex>
+#include <mutex>
+
 NoiseFadeEffect::NoiseFadeEffect() :
     RasterEffect("noise fade",
                  AppSupport::getRasterEffectHardwareSupport("NoiseFade",
@@ -83,10 +86,6 @@ protected:
         gl->glUniform1f(sTimeU, mTime);
     }
 private:
-    qreal r(const QPointF& p) const;
-    qreal n(const QPointF& p) const;
-    qreal noise(const QPointF& p) const;
-
     static bool sInitialized;
     static GLuint sProgramId;
 
@@ -155,12 +154,93 @@ QPointF GLSL_fract(const QPointF& p) {
     return p - GLSL_floor(p);
 }
 
-qreal NoiseFadeEffectCaller::r(const QPointF& p) const {
+//! @brief Noise values of NoiseFadeEffectCaller for a given image size,
+//! seed and size, independent of time and sharpness.
+//! Rows are evaluated on first use and shared between tiles, frames and renders.
+class NoiseFadeField {
+public:
+    NoiseFadeField(const int width, const int height,
+                   const qreal seed, const qreal size) :
+        mWidth(width), mHeight(height), mSeed(seed), mSize(size),
+        mValues(static_cast<size_t>(width)*static_cast<size_t>(height)),
+        mRowsDone(new std::once_flag[static_cast<size_t>(height)]) {}
+
+    static stdsptr<NoiseFadeField> sGet(const int width, const int height,
+                                        const qreal seed, const qreal size);
+
+    qint64 byteCount() const {
+        return static_cast<qint64>(mValues.size()*sizeof(float));
+    }
+
+    const float* row(const int yi) {
+        std::call_once(mRowsDone[yi], [this, yi]() { evaluateRow(yi); });
+        return mValues.data() + static_cast<size_t>(yi)*mWidth;
+    }
+private:
+    bool matches(const int width, const int height,
+                 const qreal seed, const qreal size) const {
+        return mWidth == width && mHeight == height &&
+               isZero4Dec(mSeed - seed) && isZero4Dec(mSize - size);
+    }
+
+    void evaluateRow(const int yi);
+
+    qreal r(const QPointF& p) const;
+    qreal n(const QPointF& p) const;
+    qreal noise(const QPointF& p) const;
+
+    const int mWidth;
+    const int mHeight;
+    const qreal mSeed;
+    const qreal mSize;
+
+    std::vector<float> mValues;
+    std::unique_ptr<std::once_flag[]> mRowsDone;
+
+    // two 4K (3840x2160) fields, the newest field is kept even if larger
+    static const qint64 sMaxBytes = 2*qint64(3840*2160)*sizeof(float);
+    static QMutex sFieldsMutex;
+    static QList<stdsptr<NoiseFadeField>> sFields;
+};
+
+QMutex NoiseFadeField::sFieldsMutex;
+QList<stdsptr<NoiseFadeField>> NoiseFadeField::sFields;
+
+stdsptr<NoiseFadeField> NoiseFadeField::sGet(const int width, const int height,
+                                             const qreal seed, const qreal size) {
+    QMutexLocker locker(&sFieldsMutex);
+    for(int i = 0; i < sFields.count(); i++) {
+        const auto field = sFields.at(i);
+        if(!field->matches(width, height, seed, size)) continue;
+        sFields.move(i, 0);
+        return field;
+    }
+    const auto field = std::make_shared<NoiseFadeField>(width, height,
+                                                        seed, size);
+    sFields.prepend(field);
+    qint64 bytes = 0;
+    for(const auto& cached : sFields) bytes += cached->byteCount();
+    while(bytes > sMaxBytes && sFields.count() > 1) {
+        bytes -= sFields.takeLast()->byteCount();
+    }
+    return field;
+}
+
+void NoiseFadeField::evaluateRow(const int yi) {
+    const qreal y = yi/qreal(mHeight);
+    float* dst = mValues.data() + static_cast<size_t>(yi)*mWidth;
+    for(int xi = 0; xi < mWidth; xi++) {
+        const qreal x = xi/qreal(mWidth);
+        *dst++ = static_cast<float>(noise(QPointF{x, y} * .4));
+    }
+}
+
+qreal NoiseFadeField::r(const QPointF& p) const {
     return GLSL_fract(cos((p.x() + 0.00001*mSeed)*42.98 +
                           (p.y() + 0.00001*mSeed)*43.23) * 1127.53);
 }
 
-qreal NoiseFadeEffectCaller::n(const QPointF& p) const {
+qreal NoiseFadeField::n(const QPointF& p) const {
     const QPointF fn = GLSL_floor(p);
     const QPointF sn = GLSL_smoothstep(QPointF{0. ,0.},
                                        QPointF{1., 1.},
@@ -173,7 +253,7 @@ qreal NoiseFadeEffectCaller::n(const QPointF& p) const {
     return GLSL_mix(h1 ,h2, sn.y());
 }
 
-qreal NoiseFadeEffectCaller::noise(const QPointF& p) const {
+qreal NoiseFadeField::noise(const QPointF& p) const {
     const qreal s = mSize*0.001;
     return 0.58 * n(p/(32.*s)) +
            0.2 * n(p/(16.*s)) +
@@ -185,8 +265,10 @@ qreal NoiseFadeEffectCaller::noise(const QPointF& p) const {
 
 void NoiseFadeEffectCaller::processCpu(CpuRenderTools& renderTools,
                                        const CpuRenderData& data) {
-    const qreal imgWidth = renderTools.fSrcBtmp.width();
-    const qreal imgHeight = renderTools.fSrcBtmp.height();
+    const int imgWidth = renderTools.fSrcBtmp.width();
+    const int imgHeight = renderTools.fSrcBtmp.height();
+    const auto field = NoiseFadeField::sGet(imgWidth, imgHeight,
+                                            mSeed, mSize);
 
     const int xMin = data.fTexTile.left();
     const int xMax = data.fTexTile.right();
@@ -195,18 +277,19 @@ void NoiseFadeEffectCaller::processCpu(CpuRenderTools& renderTools,
 
     const qreal t = abs(sin(0.5*PI*mTime));
     const qreal b = 0.25*(0.75 - 0.749*mSharpness);
+    // GLSL_smoothstep(t + b, t - b, noise) with the division hoisted
+    const float edge0 = static_cast<float>(t + b);
+    const float invRange = static_cast<float>(1/(-2*b));
 
-    for(int yi = yMin; yi <= yMax; yi++) {
+    for(int yi = yMin; yi < yMax; yi++) {
         auto dst = static_cast<uchar*>(renderTools.fDstBtmp.getAddr(0, yi - yMin));
         auto src = static_cast<uchar*>(renderTools.fSrcBtmp.getAddr(xMin, yi));
-        for(int xi = xMin; xi <= xMax; xi++) {
-            const qreal x = xi/imgWidth;
-            const qreal y = yi/imgHeight;
-
-            const qreal c = GLSL_smoothstep(t + b, t - b, noise(QPointF{x, y} * .4));
-
+        const float* noise = field->row(yi) + xMin;
+        for(int xi = xMin; xi < xMax; xi++) {
+            const float s = qBound(0.f, (*noise++ - edge0)*invRange, 1.f);
+            const float m = 1.f - s*s*(3.f - 2.f*s);
             for(int i = 0; i < 4; i++) {
-                *dst++ = *src++ * (1 - c);
+                *dst++ = static_cast<uchar>(*src++ * m);
             }
         }
     }
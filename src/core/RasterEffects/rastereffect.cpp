@@ -27,6 +27,10 @@
 #include "Animators/dynamiccomplexanimator.h"
 #include "typemenu.h"
 
+#include <QtMath>
+
+uint RasterEffect::sLastStateId = 0;
+
 RasterEffect::RasterEffect(const QString &name,
                            const HardwareSupport hwSupport,
                            const bool hwInterchangeable,
@@ -43,6 +47,23 @@ RasterEffect::RasterEffect(const QString &name,
     } else if(hwSupport == HardwareSupport::gpuPreffered) {
         mInstHwSupport = HardwareSupport::gpuOnly;
     } else Q_ASSERT(false);
+    mStateId = ++sLastStateId;
+    connect(this, &Property::prp_absFrameRangeChanged,
+            this, [this]() { mStateId = ++sLastStateId; });
+}
+
+uint RasterEffect::resultCacheKey(const qreal relFrame,
+                                  const qreal influence) const {
+    const int frame = qFloor(relFrame);
+    const auto idRange = prp_getIdenticalRelRange(frame);
+    const bool identical = idRange.inRange(frame) &&
+                           idRange.inRange(qCeil(relFrame));
+    const qreal keyFrame = identical ? idRange.fMin : relFrame;
+    uint result = qHash(reinterpret_cast<quintptr>(this));
+    result = qHash(mStateId, result);
+    result = qHash(keyFrame, result);
+    result = qHash(influence, result);
+    return qHash(static_cast<int>(mInstHwSupport), result);
 }
 
 void RasterEffect::writeIdentifier(eWriteStream &dst) const {
@@ -58,6 +58,11 @@ public:
             const qreal influence,
             BoxRenderData * const data) const = 0;
 
+    //! @brief False for effects depending on more than their own
+    //! parameters and the input image, e.g., other frames
+    virtual bool cacheableResult() const { return true; }
+    uint resultCacheKey(const qreal relFrame, const qreal influence) const;
+
     virtual bool forceMargin() const { return false; }
     virtual QMargins getMargin() const { return QMargins(); }
 
@@ -81,6 +86,9 @@ private:
     const HardwareSupport mTypeHwSupport;
     const bool mHwInterchangeable;
     HardwareSupport mInstHwSupport;
+    //! @brief Unique among all effects, changes with any parameter
+    uint mStateId = 0;
+    static uint sLastStateId;
 };
 
 #endif // RASTEREFFECT_H
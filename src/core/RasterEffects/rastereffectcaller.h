@@ -54,6 +54,8 @@ public:
 
     virtual int cpuThreads(const int available, const int area) const;
 
+    virtual int cpuPasses() const { return 1; }
+
     virtual bool srcDstSeparation() const { return true; }
 
     HardwareSupport hardwareSupport() const {
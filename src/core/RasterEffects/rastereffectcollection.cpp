@@ -90,7 +90,11 @@ void RasterEffectCollection::addEffects(const qreal relFrame,
         if(zeroInfluence && rEffect->skipZeroInfluence(relFrame)) continue;
         const auto effectRenderData = rEffect->getEffectCaller(
                     relFrame, data->fResolution, influence, data);
-        if(effectRenderData) data->addEffect(effectRenderData);
+        if(!effectRenderData) continue;
+        if(rEffect->cacheableResult()) {
+            const uint key = rEffect->resultCacheKey(relFrame, influence);
+            data->addEffect(effectRenderData, key);
+        } else data->addEffect(effectRenderData);
     }
 }
 
@@ -0,0 +1,112 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "scratchbufferpool.h"
+
+#include <QThread>
+#include <cstdint>
+
+QMutex ScratchBufferPool::sMutex;
+std::vector<ScratchBufferPool::Block> ScratchBufferPool::sFree;
+
+ScratchBuffer::ScratchBuffer(ScratchBuffer&& other) {
+    *this = std::move(other);
+}
+
+ScratchBuffer& ScratchBuffer::operator=(ScratchBuffer&& other) {
+    if(this == &other) return *this;
+    release();
+    mMemory = std::move(other.mMemory);
+    mCapacity = other.mCapacity;
+    mData = other.mData;
+    mSize = other.mSize;
+    other.mCapacity = 0;
+    other.mData = nullptr;
+    other.mSize = 0;
+    return *this;
+}
+
+ScratchBuffer::~ScratchBuffer() {
+    release();
+}
+
+void ScratchBuffer::release() {
+    if(!mMemory) return;
+    ScratchBufferPool::sReturn(std::move(mMemory), mCapacity);
+    mCapacity = 0;
+    mData = nullptr;
+    mSize = 0;
+}
+
+ScratchBuffer ScratchBufferPool::sRequest(const size_t bytes) {
+    ScratchBuffer result;
+    if(bytes == 0) return result;
+    const size_t capacity = bytes + sAlignment - 1;
+    {
+        QMutexLocker locker(&sMutex);
+        // smallest free block that fits
+        int bestId = -1;
+        for(int i = 0; i < static_cast<int>(sFree.size()); i++) {
+            const auto& block = sFree[static_cast<size_t>(i)];
+            if(block.fCapacity < capacity) continue;
+            if(bestId == -1 ||
+               block.fCapacity < sFree[static_cast<size_t>(bestId)].fCapacity) {
+                bestId = i;
+            }
+        }
+        if(bestId != -1) {
+            auto& block = sFree[static_cast<size_t>(bestId)];
+            result.mMemory = std::move(block.fMemory);
+            result.mCapacity = block.fCapacity;
+            sFree.erase(sFree.begin() + bestId);
+        }
+    }
+    if(!result.mMemory) {
+        result.mMemory.reset(new char[capacity]);
+        result.mCapacity = capacity;
+    }
+    const auto address = reinterpret_cast<uintptr_t>(result.mMemory.get());
+    const auto aligned = (address + sAlignment - 1) & ~(sAlignment - 1);
+    result.mData = reinterpret_cast<void*>(aligned);
+    result.mSize = bytes;
+    return result;
+}
+
+void ScratchBufferPool::sClear() {
+    QMutexLocker locker(&sMutex);
+    sFree.clear();
+}
+
+void ScratchBufferPool::sReturn(std::unique_ptr<char[]>&& memory,
+                                const size_t capacity) {
+    QMutexLocker locker(&sMutex);
+    // keep about two buffers per CPU thread, drop the smallest above that
+    const size_t maxFree = static_cast<size_t>(2*QThread::idealThreadCount());
+    sFree.push_back({std::move(memory), capacity});
+    if(sFree.size() <= maxFree) return;
+    auto smallest = sFree.begin();
+    for(auto it = sFree.begin(); it != sFree.end(); it++) {
+        if(it->fCapacity < smallest->fCapacity) smallest = it;
+    }
+    sFree.erase(smallest);
+}
@@ -0,0 +1,84 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef SCRATCHBUFFERPOOL_H
+#define SCRATCHBUFFERPOOL_H
+
+#include "core_global.h"
+
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+class ScratchBufferPool;
+
+//! @brief Aligned temporary memory for raster effect tiles,
+//! returned to the pool when destroyed.
+class CORE_EXPORT ScratchBuffer {
+    friend class ScratchBufferPool;
+public:
+    ScratchBuffer() = default;
+    ScratchBuffer(ScratchBuffer&& other);
+    ScratchBuffer& operator=(ScratchBuffer&& other);
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+    ~ScratchBuffer();
+
+    void* data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool isNull() const { return !mData; }
+
+    template <typename T>
+    T* as() const { return static_cast<T*>(mData); }
+private:
+    void release();
+
+    std::unique_ptr<char[]> mMemory;
+    size_t mCapacity = 0;
+    void* mData = nullptr;
+    size_t mSize = 0;
+};
+
+class CORE_EXPORT ScratchBufferPool {
+    friend class ScratchBuffer;
+    ScratchBufferPool() = delete;
+public:
+    //! @brief Alignment of every returned buffer, suits 512-bit SIMD loads
+    static const size_t sAlignment = 64;
+
+    static ScratchBuffer sRequest(const size_t bytes);
+    static void sClear();
+private:
+    struct Block {
+        std::unique_ptr<char[]> fMemory;
+        size_t fCapacity;
+    };
+
+    static void sReturn(std::unique_ptr<char[]>&& memory,
+                        const size_t capacity);
+
+    static QMutex sMutex;
+    static std::vector<Block> sFree;
+};
+
+#endif // SCRATCHBUFFERPOOL_H
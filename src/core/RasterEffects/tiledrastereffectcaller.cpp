@@ -0,0 +1,79 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "tiledrastereffectcaller.h"
+
+#include <cstdint>
+
+static size_t rowAlignment(const SkBitmap& bitmap) {
+    const auto address = reinterpret_cast<uintptr_t>(bitmap.getPixels()) |
+                         static_cast<uintptr_t>(bitmap.rowBytes());
+    // lowest set bit, capped at the scratch buffer alignment
+    const size_t alignment = static_cast<size_t>(address & (~address + 1));
+    if(alignment == 0) return ScratchBufferPool::sAlignment;
+    return qMin(alignment, ScratchBufferPool::sAlignment);
+}
+
+TiledRasterEffectCaller::TiledRasterEffectCaller(const HardwareSupport hwSupport,
+                                                 const bool forceMargin,
+                                                 const QMargins &margin) :
+    RasterEffectCaller(hwSupport, forceMargin, margin) {}
+
+void TiledRasterEffectCaller::processCpu(CpuRenderTools &renderTools,
+                                         const CpuRenderData &data) {
+    const auto& srcBtmp = renderTools.fSrcBtmp;
+    const auto& tile = data.fTexTile;
+
+    TileRenderData tileData;
+    tileData.fTile = tile;
+    tileData.fPos = data.fPos;
+    tileData.fWidth = static_cast<int>(data.fWidth);
+    tileData.fHeight = static_cast<int>(data.fHeight);
+    tileData.fPass = data.fPass;
+    tileData.fPassCount = data.fPassCount;
+    tileData.fThreads = data.fThreads;
+
+    SkIRect srcRect = tile;
+    if(!pointwise()) {
+        const auto margin = tileMargin(data.fPass);
+        srcRect = SkIRect::MakeLTRB(tile.left() - margin.left(),
+                                    tile.top() - margin.top(),
+                                    tile.right() + margin.right(),
+                                    tile.bottom() + margin.bottom());
+        if(!srcRect.intersect(srcBtmp.bounds())) return;
+    }
+    tileData.fSrcRect = srcRect;
+
+    TileRenderTools tools;
+    srcBtmp.extractSubset(&tools.fSrc, srcRect);
+    tools.fDst = renderTools.fDstBtmp;
+    tools.fTileOffset = SkIPoint::Make(tile.left() - srcRect.left(),
+                                       tile.top() - srcRect.top());
+    tileData.fRowAlignment = qMin(rowAlignment(tools.fSrc),
+                                  rowAlignment(tools.fDst));
+
+    const size_t bytes = scratchBytes(tileData);
+    if(bytes > 0) tools.fScratch = ScratchBufferPool::sRequest(bytes);
+
+    processTile(tools, tileData);
+}
@@ -0,0 +1,107 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef TILEDRASTEREFFECTCALLER_H
+#define TILEDRASTEREFFECTCALLER_H
+
+#include "rastereffectcaller.h"
+#include "scratchbufferpool.h"
+
+struct CORE_EXPORT TileRenderData {
+    //! @brief Destination tile rect in texture coordinates
+    SkIRect fTile;
+
+    //! @brief Tile rect outset by tileMargin(), clamped to the texture
+    SkIRect fSrcRect;
+
+    //! @brief Pixel {0, 0} position in scene coordinates
+    QPoint fPos;
+
+    //! @brief Texture size
+    int fWidth;
+    int fHeight;
+
+    //! @brief Current pass, each pass reads the output of the previous one
+    int fPass;
+    int fPassCount;
+
+    //! @brief Number of tiles processed in parallel for this pass
+    int fThreads;
+
+    //! @brief Alignment of fSrc/fDst row starts, in bytes (at least 4)
+    size_t fRowAlignment;
+};
+
+struct CORE_EXPORT TileRenderTools {
+    //! @brief Source pixels covering TileRenderData::fSrcRect
+    SkBitmap fSrc;
+
+    //! @brief Destination pixels covering TileRenderData::fTile
+    SkBitmap fDst;
+
+    //! @brief TileRenderData::fTile top-left position within fSrc
+    SkIPoint fTileOffset;
+
+    //! @brief Aligned scratch memory, scratchBytes() long
+    ScratchBuffer fScratch;
+};
+
+//! @brief Custom raster effect interface v2 (CUSTOM_API_VERSION 2),
+//! tiling, margins, scratch memory and passes are handled by the engine.
+class CORE_EXPORT TiledRasterEffectCaller : public RasterEffectCaller {
+public:
+    TiledRasterEffectCaller(const HardwareSupport hwSupport,
+                            const bool forceMargin = false,
+                            const QMargins& margin = QMargins());
+
+    //! @brief Input margin each tile needs around its destination rect
+    virtual QMargins tileMargin(const int pass) const {
+        Q_UNUSED(pass)
+        return fMargin;
+    }
+
+    //! @brief Pointwise effects only read the pixel they write,
+    //! they need no margin and are processed in place
+    virtual bool pointwise() const { return false; }
+
+    //! @brief Separable and other multi-pass effects return the pass count
+    virtual int passCount() const { return 1; }
+
+    //! @brief Scratch memory needed by a single tile in the given pass
+    virtual size_t scratchBytes(const TileRenderData& data) const {
+        Q_UNUSED(data)
+        return 0;
+    }
+
+    virtual void processTile(TileRenderTools& tools,
+                             const TileRenderData& data) = 0;
+
+    void processCpu(CpuRenderTools& renderTools,
+                    const CpuRenderData& data) final;
+
+    int cpuPasses() const final { return qMax(1, passCount()); }
+
+    bool srcDstSeparation() const { return !pointwise(); }
+};
+
+#endif // TILEDRASTEREFFECTCALLER_H
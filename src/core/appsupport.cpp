@@ -42,10 +42,21 @@
 #include <QRegularExpression>
 #include <QMessageBox>
 #include <QFontDatabase>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTemporaryFile>
 
 #include <iostream>
 #include <ostream>
 
+#ifdef Q_OS_LINUX
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#endif
+
 extern "C" {
 #include <libavutil/log.h>
 #include <libavformat/avformat.h>
@@ -294,6 +305,36 @@ const QString AppSupport::getAppTempPath()
     return QDir::tempPath();
 }
 
+const QString AppSupport::getAppProxyPath()
+{
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (path.isEmpty()) { path = getAppTempPath(); }
+    path.append("/proxies");
+    QDir dir(path);
+    if (!dir.exists()) { dir.mkpath(path); }
+    return path;
+}
+
+const QString AppSupport::getAppSeekIndexPath()
+{
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (path.isEmpty()) { path = getAppTempPath(); }
+    path.append("/indexes");
+    QDir dir(path);
+    if (!dir.exists()) { dir.mkpath(path); }
+    return path;
+}
+
+const QString AppSupport::getFileCacheKey(const QString &path)
+{
+    const QFileInfo info(path);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
 const QString AppSupport::getAppOutputProfilesPath()
 {
     QString path = QString::fromUtf8("%1/OutputProfiles").arg(getAppConfigPath());
@@ -1017,9 +1058,146 @@ void AppSupport::checkFFmpeg(const bool &isRenderer)
 #endif
 }
 
-void AppSupport::initEnv(const bool &isRenderer)
+bool AppSupport::isHeadless()
+{
+#ifdef Q_OS_LINUX
+    return qgetenv("DISPLAY").isEmpty() &&
+           qgetenv("WAYLAND_DISPLAY").isEmpty();
+#else
+    return false;
+#endif
+}
+
+bool AppSupport::useSoftwareGL(int argc,
+                               char *argv[])
+{
+    // force with '--software-gl' or FRICTION_SOFTWARE_GL=1 (benchmarking)
+    if (hasArg(argc, argv, "--software-gl")) { return true; }
+    if (qEnvironmentVariableIsSet("FRICTION_SOFTWARE_GL")) {
+        return qEnvironmentVariableIntValue("FRICTION_SOFTWARE_GL") != 0;
+    }
+    return false;
+}
+
+#ifdef Q_OS_LINUX
+static pid_t sXvfbPid = 0;
+
+static void stopXvfb()
+{
+    if (sXvfbPid <= 0) { return; }
+    kill(sXvfbPid, SIGTERM);
+    waitpid(sXvfbPid, nullptr, 0);
+    sXvfbPid = 0;
+}
+
+static bool startXvfb()
 {
+    int fds[2];
+    if (pipe(fds) != 0) { return false; }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // the server goes away with us, even if we crash
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        close(fds[0]);
+        const QByteArray fd = QByteArray::number(fds[1]);
+        execlp("Xvfb", "Xvfb", "-displayfd", fd.constData(),
+               "-screen", "0", "640x480x24", "-nolisten", "tcp",
+               static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(fds[1]);
+    // the server writes its display number once it accepts connections
+    QByteArray display;
+    char c;
+    while (read(fds[0], &c, 1) == 1 && c != '\n') { display.append(c); }
+    close(fds[0]);
+    if (display.isEmpty()) {
+        waitpid(pid, nullptr, 0);
+        return false;
+    }
+    sXvfbPid = pid;
+    std::atexit(stopXvfb);
+    qputenv("DISPLAY", ":" + display);
+    return true;
+}
+
+static QString renderNode()
+{
+    const QDir dri("/dev/dri");
+    const auto nodes = dri.entryList({"renderD*"}, QDir::System, QDir::Name);
+    for (const auto &node : nodes) {
+        const QFileInfo info(dri.absoluteFilePath(node));
+        if (info.isReadable() && info.isWritable()) { return info.absoluteFilePath(); }
+    }
+    return QString();
+}
+#endif
+
+bool AppSupport::initHeadless(const bool &isRenderer,
+                              const bool &softwareGL)
+{
+#ifdef Q_OS_LINUX
+    if (!isHeadless() || qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) { return true; }
+    // the user interface needs a display, only the renderer can go without
+    if (!isRenderer) { return false; }
+#ifdef FRICTION_EGL
+    // a GPU is still usable without display server, render offscreen
+    // through the headless mode of eglfs on the DRM render node
+    const QString node = softwareGL ? QString() : renderNode();
+    if (!node.isEmpty()) {
+        static QTemporaryFile config(QDir::tempPath() + "/friction-kms-XXXXXX.json");
+        if (config.open()) {
+            config.write(QString("{ \"device\": \"%1\", \"headless\": \"640x480\" }")
+                         .arg(node).toUtf8());
+            config.flush();
+            qputenv("QT_QPA_PLATFORM", "eglfs");
+            qputenv("QT_QPA_EGLFS_INTEGRATION", "eglfs_kms");
+            qputenv("QT_QPA_EGLFS_KMS_CONFIG", config.fileName().toUtf8());
+            return true;
+        }
+    }
+#else
+    Q_UNUSED(softwareGL)
+#endif
+    // no GPU (or GLX build), Mesa renders on the CPU on a private X server
+    if (!startXvfb()) { return false; }
+    qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+    return true;
+#else
     Q_UNUSED(isRenderer)
+    Q_UNUSED(softwareGL)
+    return true;
+#endif
+}
+
+void AppSupport::initEnv(const bool &isRenderer,
+                         const bool &softwareGL)
+{
+#if defined(Q_OS_LINUX)
+    if (softwareGL) {
+        // Mesa llvmpipe provides OpenGL 3.3 core on the CPU,
+        // this keeps GpuExecController and shader effects available
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+        if (!qEnvironmentVariableIsSet("GALLIUM_DRIVER")) {
+            qputenv("GALLIUM_DRIVER", "llvmpipe");
+        }
+    }
+    if (isRenderer) {
+        // the renderer never creates windows, keep away from the display
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        return;
+    }
+#else
+    Q_UNUSED(isRenderer)
+    Q_UNUSED(softwareGL)
+#endif
 #if defined(Q_OS_WIN)
     // windows theme integration
 #if QT_VERSION < QT_VERSION_CHECK(6, 5, 0)
@@ -1056,11 +1234,13 @@ QPair<bool, int> AppSupport::handleXDGArgs(const bool &isRenderer,
     return status;
 }
 
-void AppSupport::printVersion()
+void AppSupport::printVersion(const bool &isRenderer)
 {
-    std::cout << QString("%1 %2 - %3").arg(getAppDisplayName(),
-                                           getAppVersion(),
-                                           getAppUrl()).toStdString() << std::endl;
+    // the renderer keeps stdout clean for frames streamed with --pipe
+    auto &out = isRenderer ? std::cerr : std::cout;
+    out << QString("%1 %2 - %3").arg(getAppDisplayName(),
+                                     getAppVersion(),
+                                     getAppUrl()).toStdString() << std::endl;
 }
 
 void AppSupport::printHelp(const bool &isRenderer)
@@ -83,6 +83,9 @@ public:
     static const QString getAppConfigPath();
     static const QString getAppPath();
     static const QString getAppTempPath();
+    static const QString getAppProxyPath();
+    static const QString getAppSeekIndexPath();
+    static const QString getFileCacheKey(const QString &path);
     static const QString getAppOutputProfilesPath();
     static const QString getAppPathEffectsPath();
     static const QString getAppRasterEffectsPath();
@@ -134,10 +137,19 @@ public:
                        const QString &find);
     static void checkPerms(const bool &isRenderer);
     static void checkFFmpeg(const bool &isRenderer);
-    static void initEnv(const bool &isRenderer);
+    static bool isHeadless();
+    static bool useSoftwareGL(int argc,
+                              char *argv[]);
+    //! @brief Picks an OpenGL path for the renderer when there is no display
+    //! server: eglfs on the GPU render node (EGL builds), or else software
+    //! GL on a private Xvfb. False if none is available.
+    static bool initHeadless(const bool &isRenderer,
+                             const bool &softwareGL);
+    static void initEnv(const bool &isRenderer,
+                        const bool &softwareGL = false);
     static QPair<bool,int> handleXDGArgs(const bool &isRenderer,
                                          const QStringList &args);
-    static void printVersion();
+    static void printVersion(const bool &isRenderer);
     static void printHelp(const bool &isRenderer);
     static void handlePortableFirstRun();
     static const QString filterId(const QString &input);
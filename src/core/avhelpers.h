@@ -0,0 +1,45 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef AVHELPERS_H
+#define AVHELPERS_H
+
+#include "exceptions.h"
+
+extern "C" {
+    #include <libavutil/error.h>
+}
+
+//! @brief Throws the FFmpeg error text of errId, nested in message
+#define AV_RuntimeThrow(errId, message) \
+{ \
+    char errMsg[AV_ERROR_MAX_STRING_SIZE]; \
+    av_make_error_string(errMsg, AV_ERROR_MAX_STRING_SIZE, errId); \
+    try { \
+        RuntimeThrow(errMsg); \
+    } catch(...) { \
+        RuntimeThrow(message); \
+    } \
+}
+
+#endif // AVHELPERS_H
@@ -520,6 +520,11 @@ public:
         return mPreviewing || mRenderingPreview || mRenderingOutput;
     }
 
+    bool isOutputRendering() const
+    {
+        return mRenderingOutput;
+    }
+
     qreal getFps() const
     {
         return mFps;
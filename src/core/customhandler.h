@@ -27,10 +27,20 @@
 #define CUSTOMHANDLER_H
 #include <QList>
 #include <QLibrary>
+#include <type_traits>
 #include "smartPointers/ememory.h"
 #include "typemenu.h"
 #include "customidentifier.h"
 
+class RasterEffect;
+
+//! @brief Newest plugin interface version, exported by plugins as 'eApiVersion'.
+//! Required for raster effects, older libraries were built against a
+//! different RasterEffectCaller vtable and have to be rebuilt.
+//! 1 - RasterEffectCaller::processCpu on the whole source bitmap
+//! 2 - TiledRasterEffectCaller::processTile
+#define CUSTOM_API_VERSION 2
+
 template <typename B, typename C>
 class CustomHandler {
 public:
@@ -39,6 +49,7 @@ public:
     typedef QString (*CNameFunc)();
     typedef CustomIdentifier (*CIdentifierFunc)();
     typedef bool (*CSupport)(const CustomIdentifier&);
+    typedef int (*CApiVersion)();
 
     CustomHandler(const CCreatorNewFunc& creatorNew,
                   const CCreatorFunc& creator,
@@ -125,6 +136,19 @@ void CustomHandler<B, C>::sLoadCustom(const QString &libPath) {
                 lib.resolve("eSupports"));
     if(!supportFunc) RuntimeThrow("Could not resolve 'eSupports' symbol");
 
+    const auto apiVersionFunc = reinterpret_cast<CApiVersion>(
+                lib.resolve("eApiVersion"));
+    if(apiVersionFunc) {
+        const int apiVersion = apiVersionFunc();
+        if(apiVersion < 1 || apiVersion > CUSTOM_API_VERSION) {
+            RuntimeThrow("Unsupported plugin API version " +
+                         QString::number(apiVersion));
+        }
+    } else if(std::is_same<B, RasterEffect>::value) {
+        RuntimeThrow("Could not resolve 'eApiVersion' symbol, "
+                     "rebuild the plugin against the current headers");
+    }
+
     CustomHandler handler(creatorNewFunc, creatorFunc, nameFunc,
                           identifierFunc, supportFunc);
     sCreators.append(handler);
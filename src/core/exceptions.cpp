@@ -90,13 +90,22 @@ QString gAllTextFromException(const std::exception &e,
     return allText;
 }
 
+static bool gExceptionDialogs = true;
+
+void gSetExceptionDialogs(const bool enabled) {
+    gExceptionDialogs = enabled;
+}
+
 void gPrintException(const bool fatal, const QString &allText) {
+    // headless, nobody could close the message box
+    if(!gExceptionDialogs) return;
     const QString txt = fatal ? "Fatal" : "Critical";
     const auto icon = fatal ? QMessageBox::Critical : QMessageBox::Warning;
     QMessageBox(icon, txt + " Error", allText).exec();
 }
 
 void gPrintException(const QString &allText) {
+    if(!gExceptionDialogs) qCritical() << allText;
     gPrintException(false, allText);
 }
 
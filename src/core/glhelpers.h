@@ -74,6 +74,13 @@ struct CORE_EXPORT CpuRenderData {
     //! @brief Texture size
     uint fWidth;
     uint fHeight;
+
+    //! @brief Current pass of RasterEffectCaller::cpuPasses()
+    int fPass = 0;
+    int fPassCount = 1;
+
+    //! @brief Number of tiles processed in parallel
+    int fThreads = 1;
 };
 
 #endif // GLHELPERS_H
@@ -102,6 +102,10 @@ const QPair<GpuVendor, QStringList> gpuVendor()
         checkVendor("advanced micro devices")) {
         gpu = GpuVendor::amd;
     }
+    if (checkVendor("llvmpipe") || checkVendor("softpipe") ||
+        checkVendor("swrast")) {
+        gpu = GpuVendor::software;
+    }
 
     QStringList specs;
     QString na = QObject::tr("Unknown");
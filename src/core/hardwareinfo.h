@@ -41,6 +41,7 @@ public:
     static const QString sGpuVendorString() { return mGpuVendorString; }
     static const QString sGpuRendererString() { return mGpuRendererString; }
     static const QString sGpuVersionString() { return mGpuVersionString; }
+    static bool sGpuIsSoftware() { return mGpuVendor == GpuVendor::software; }
 
 private:
     static int mCpuThreads;
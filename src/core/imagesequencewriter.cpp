@@ -0,0 +1,235 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "imagesequencewriter.h"
+
+#include <QFile>
+#include <cstring>
+
+#include "avhelpers.h"
+#include "videoencoder.h"
+#include "renderstats.h"
+#include "Tasks/updatable.h"
+
+extern "C" {
+    #include <libavutil/opt.h>
+}
+
+using namespace Friction::Core;
+
+struct ImageSequenceFrame {
+    ~ImageSequenceFrame() {
+        if(fCodec) avcodec_free_context(&fCodec);
+        if(fFrame) av_frame_free(&fFrame);
+    }
+
+    AVCodecContext *fCodec = nullptr;
+    AVFrame *fFrame = nullptr;
+    SkBitmap fUnpremul;
+};
+
+static int startNumber(const OutputSettings &outSettings) {
+    for(const auto &opt : outSettings.fVideoOptions.fValues) {
+        if(opt.fType != FormatType::fTypeFormat) continue;
+        if(opt.fKey != "start_number") continue;
+        bool ok = false;
+        const int number = opt.fValue.toInt(&ok);
+        if(ok) return number;
+    }
+    return 1; // image2 default
+}
+
+ImageSequenceWriter::ImageSequenceWriter(const AVCodecContext * const codec,
+                                         const OutputSettings &outSettings,
+                                         const QByteArray &pattern) :
+    mCodec(codec->codec),
+    mOutputSettings(outSettings),
+    mPattern(pattern),
+    mTimeBase(codec->time_base),
+    mCompressionLevel(codec->compression_level),
+    mNextNumber(startNumber(outSettings)) {
+    mParams = avcodec_parameters_alloc();
+    if(!mParams) RuntimeThrow("Could not allocate codec parameters");
+    const int ret = avcodec_parameters_from_context(mParams, codec);
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not copy the codec parameters")
+}
+
+ImageSequenceWriter::~ImageSequenceWriter() {
+    qDeleteAll(mIdle);
+    avcodec_parameters_free(&mParams);
+}
+
+bool ImageSequenceWriter::sSupported(const AVOutputFormat * const format,
+                                     const OutputSettings &outSettings,
+                                     const QByteArray &pattern) {
+    if(!format || std::strcmp(format->name, "image2")) return false;
+    const auto codec = outSettings.fVideoCodec;
+    if(!codec || !outSettings.fVideoEnabled) return false;
+    const auto desc = avcodec_descriptor_get(codec->id);
+    if(!desc || !(desc->props & AV_CODEC_PROP_INTRA_ONLY)) return false;
+    // leave anything but numbering to the image2 muxer
+    for(const auto &opt : outSettings.fVideoOptions.fValues) {
+        if(opt.fType != FormatType::fTypeFormat) continue;
+        if(opt.fKey != "start_number") return false;
+    }
+    char path[4096];
+    return av_get_frame_filename2(path, sizeof(path),
+                                  pattern.constData(), 1, 0) >= 0;
+}
+
+void ImageSequenceWriter::write(const sk_sp<SkImage> &image,
+                                const int count) {
+    const int number = mNextNumber;
+    mNextNumber += count;
+    mPending++;
+    // queued tasks keep the writer alive
+    const auto writer = ref<ImageSequenceWriter>();
+    const auto run = [writer, image, number, count]() {
+        if(writer->mAborted) return;
+        try {
+            writer->writeFrame(image, number, count);
+        } catch(...) {
+            QMutexLocker lock(&writer->mMutex);
+            if(!writer->mError) writer->mError = std::current_exception();
+        }
+    };
+    const auto done = [writer]() { writer->frameDone(); };
+    const auto task = enve::make_shared<eCustomCpuTask>(
+                nullptr, run, done, done);
+    task->queTask();
+}
+
+void ImageSequenceWriter::abort() {
+    mAborted = true;
+    mDone = nullptr;
+}
+
+void ImageSequenceWriter::checkError() {
+    QMutexLocker lock(&mMutex);
+    if(mError) std::rethrow_exception(mError);
+}
+
+static QString framePath(const QByteArray &pattern, const int number) {
+    char path[4096];
+    if(av_get_frame_filename2(path, sizeof(path),
+                              pattern.constData(), number, 0) < 0) {
+        RuntimeThrow("Invalid image sequence file name " +
+                     pattern.constData());
+    }
+    return QString::fromUtf8(path);
+}
+
+void ImageSequenceWriter::writeFrame(const sk_sp<SkImage> &image,
+                                     const int number, const int count) {
+    const auto frame = acquireFrame();
+    AVPacket *pkt = av_packet_alloc();
+    try {
+        if(!pkt) RuntimeThrow("Could not allocate packet");
+        VideoEncoder::sConvertFrame(image, frame->fCodec, frame->fFrame,
+                                    frame->fUnpremul);
+        frame->fFrame->pts = number;
+
+        int ret = avcodec_send_frame(frame->fCodec, frame->fFrame);
+        if(ret < 0) AV_RuntimeThrow(ret, "Error submitting a frame for encoding")
+        // intra-only codecs return the packet right away
+        ret = avcodec_receive_packet(frame->fCodec, pkt);
+        if(ret < 0) AV_RuntimeThrow(ret, "Error encoding a video frame")
+
+        const RenderStats::Timer timer(RenderStats::Stage::muxing);
+        QFile file(framePath(mPattern, number));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            RuntimeThrow("Could not open " + file.fileName());
+        }
+        const auto data = reinterpret_cast<const char*>(pkt->data);
+        if(file.write(data, pkt->size) != pkt->size) {
+            RuntimeThrow("Could not write " + file.fileName());
+        }
+        file.close();
+        // held frames are identical files
+        for(int i = 1; i < count; i++) {
+            const QString copyPath = framePath(mPattern, number + i);
+            QFile::remove(copyPath);
+            if(!QFile::copy(file.fileName(), copyPath)) {
+                RuntimeThrow("Could not write " + copyPath);
+            }
+        }
+    } catch(...) {
+        av_packet_free(&pkt);
+        // the codec state is unknown, do not reuse it
+        delete frame;
+        throw;
+    }
+    av_packet_free(&pkt);
+    releaseFrame(frame);
+}
+
+ImageSequenceFrame *ImageSequenceWriter::acquireFrame() {
+    {
+        QMutexLocker lock(&mMutex);
+        if(!mIdle.isEmpty()) return mIdle.takeLast();
+    }
+    const auto frame = new ImageSequenceFrame;
+    try {
+        const auto c = avcodec_alloc_context3(mCodec);
+        if(!c) RuntimeThrow("Could not alloc an encoding context");
+        frame->fCodec = c;
+        int ret = avcodec_parameters_to_context(c, mParams);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not copy the codec parameters")
+        c->time_base = mTimeBase;
+        c->compression_level = mCompressionLevel;
+        // frames are already encoded in parallel
+        c->thread_count = 1;
+        for(const auto &opt : mOutputSettings.fVideoOptions.fValues) {
+            if(opt.fType != FormatType::fTypeCodec) continue;
+            av_opt_set(c->priv_data,
+                       opt.fKey.toStdString().c_str(),
+                       opt.fValue.toStdString().c_str(), 0);
+        }
+        ret = avcodec_open2(c, mCodec, nullptr);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not open codec")
+
+        frame->fFrame = av_frame_alloc();
+        if(!frame->fFrame) RuntimeThrow("Could not allocate frame");
+        frame->fFrame->format = c->pix_fmt;
+        frame->fFrame->width = c->width;
+        frame->fFrame->height = c->height;
+        ret = av_frame_get_buffer(frame->fFrame, 0);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not allocate frame data")
+    } catch(...) {
+        delete frame;
+        throw;
+    }
+    return frame;
+}
+
+void ImageSequenceWriter::releaseFrame(ImageSequenceFrame * const frame) {
+    QMutexLocker lock(&mMutex);
+    mIdle << frame;
+}
+
+void ImageSequenceWriter::frameDone() {
+    if(--mPending > 0 || !mDone) return;
+    const auto done = mDone;
+    mDone = nullptr;
+    done();
+}
@@ -0,0 +1,97 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef IMAGESEQUENCEWRITER_H
+#define IMAGESEQUENCEWRITER_H
+
+#include "core_global.h"
+
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
+
+#include "skia/skiaincludes.h"
+#include "smartPointers/stdselfref.h"
+#include "outputsettings.h"
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libavformat/avformat.h>
+}
+
+struct ImageSequenceFrame;
+
+//! @brief Writes image sequence frames as independent CPU tasks qued
+//! through the TaskScheduler, each frame encoded with a pooled codec
+//! context straight to its own file. Main thread only, except checkError().
+class CORE_EXPORT ImageSequenceWriter : public StdSelfRef {
+    e_OBJECT
+protected:
+    //! @brief Takes the codec settings from the opened video codec.
+    ImageSequenceWriter(const AVCodecContext * const codec,
+                        const OutputSettings &outSettings,
+                        const QByteArray &pattern);
+public:
+    ~ImageSequenceWriter();
+
+    //! @brief True for intra-only codecs muxed by image2 with a plain
+    //! numbered file pattern.
+    static bool sSupported(const AVOutputFormat * const format,
+                           const OutputSettings &outSettings,
+                           const QByteArray &pattern);
+    //! @brief Ques the image as the next count frames, the held frames
+    //! are copies of the first written file.
+    void write(const sk_sp<SkImage> &image, const int count);
+    //! @brief True while qued frames are not written yet.
+    bool pending() const { return mPending > 0; }
+    //! @brief Calls func once the pending frames are written.
+    void whenDone(const std::function<void()> &func) { mDone = func; }
+    //! @brief Qued frames not written yet get skipped, whenDone() is dropped.
+    void abort();
+    //! @brief Throws the error of the first failed frame, if any.
+    void checkError();
+private:
+    void writeFrame(const sk_sp<SkImage> &image,
+                    const int number, const int count);
+    ImageSequenceFrame *acquireFrame();
+    void releaseFrame(ImageSequenceFrame * const frame);
+    void frameDone();
+
+    const AVCodec *mCodec;
+    const OutputSettings mOutputSettings;
+    const QByteArray mPattern;
+    AVCodecParameters *mParams = nullptr;
+    AVRational mTimeBase;
+    int mCompressionLevel;
+    int mNextNumber;
+    int mPending = 0;
+    std::function<void()> mDone;
+    std::atomic<bool> mAborted{false};
+
+    QMutex mMutex;
+    std::exception_ptr mError;
+    QList<ImageSequenceFrame*> mIdle;
+};
+
+#endif // IMAGESEQUENCEWRITER_H
@@ -23,6 +23,11 @@
 #include "outputsettings.h"
 #include "ReadWrite/evformat.h"
 #include "appsupport.h"
+#include <QDir>
+
+extern "C" {
+    #include <libavutil/pixdesc.h>
+}
 
 using namespace Friction::Core;
 
@@ -111,6 +116,25 @@ uint64_t OutputSettings::sGetChannelsLayout(const QString &name)
     return AV_CH_LAYOUT_STEREO;
 }
 
+OutputSettings OutputSettings::sPipeSettings(const QString &format)
+{
+    OutputSettings settings;
+    settings.fVideoEnabled = true;
+    settings.fVideoCodec = avcodec_find_encoder(AV_CODEC_ID_RAWVIDEO);
+    if (format == "y4m") {
+        settings.fOutputFormat = av_guess_format("yuv4mpegpipe", nullptr, nullptr);
+        settings.fVideoPixelFormat = AV_PIX_FMT_YUV420P;
+    } else {
+        settings.fOutputFormat = av_guess_format("rawvideo", nullptr, nullptr);
+        settings.fVideoPixelFormat = av_get_pix_fmt(format.toUtf8().constData());
+    }
+    if (!settings.fVideoCodec ||
+        settings.fVideoPixelFormat == AV_PIX_FMT_NONE) {
+        settings.fOutputFormat = nullptr;
+    }
+    return settings;
+}
+
 void OutputSettings::write(eWriteStream &dst) const
 {
     dst << (fOutputFormat ? QString(fOutputFormat->name) : "");
@@ -346,6 +370,25 @@ OutputSettingsProfile *OutputSettingsProfile::sGetByName(const QString &name)
     return nullptr;
 }
 
+void OutputSettingsProfile::sLoadOutputProfiles()
+{
+    if (sOutputProfilesLoaded) { return; }
+    sOutputProfilesLoaded = true;
+    QDir dirPath(AppSupport::getAppOutputProfilesPath());
+    dirPath.setSorting(QDir::SortFlag::Name);
+    for (const auto &fileInfo : dirPath.entryInfoList()) {
+        if (!fileInfo.isFile()) { continue; }
+        if (!fileInfo.completeSuffix().contains("conf")) { continue; }
+        const auto profile = enve::make_shared<OutputSettingsProfile>();
+        try {
+            profile->load(fileInfo.absoluteFilePath());
+        } catch(const std::exception& e) {
+            gPrintExceptionCritical(e);
+        }
+        sOutputProfiles << profile;
+    }
+}
+
 FormatOptions OutputSettingsProfile::toFormatOptions(const FormatOptionsList &list)
 {
     FormatOptions options;
@@ -48,6 +48,9 @@ struct CORE_EXPORT OutputSettings
     static const std::map<int, QString> sSampleFormatNames;
     static QString sGetChannelsLayoutName(const uint64_t &layout);
     static uint64_t sGetChannelsLayout(const QString &name);
+    //! @brief Uncompressed video for a pipe, YUV4MPEG2 for "y4m" or bare
+    //! frames in the named pixel format, fOutputFormat is null if unknown
+    static OutputSettings sPipeSettings(const QString &format);
 
     void write(eWriteStream& dst) const;
     void read(eReadStream& src);
@@ -94,6 +97,8 @@ public:
     const QString &path() const { return mPath; }
 
     static OutputSettingsProfile* sGetByName(const QString &name);
+    //! @brief Loads the user profiles once, from getAppOutputProfilesPath()
+    static void sLoadOutputProfiles();
     static QList<qsptr<OutputSettingsProfile>> sOutputProfiles;
     static bool sOutputProfilesLoaded;
 
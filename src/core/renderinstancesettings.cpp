@@ -26,6 +26,13 @@
 #include "renderinstancesettings.h"
 #include "canvas.h"
 #include "simpletask.h"
+#include "renderstats.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QRegularExpression>
 
 RenderInstanceSettings::RenderInstanceSettings(Canvas* canvas) {
     setTargetCanvas(canvas);
@@ -122,6 +129,9 @@ void RenderInstanceSettings::setRenderSettings(
 
 void RenderInstanceSettings::renderingAboutToStart() {
     mRenderError.clear();
+    mCurrentRenderFrame = mRenderSettings.fMinFrame;
+    mRenderElapsed = 0;
+    mRenderTimer.start();
     mRenderSettings.fTimeBase = { 1, qRound(mRenderSettings.fFps) };
     mRenderSettings.fFrameInc = mRenderSettings.fBaseFps/mRenderSettings.fFps;
 }
@@ -131,6 +141,19 @@ void RenderInstanceSettings::setCurrentState(const RenderState &state,
                                              const QString &text) {
     mState = state;
     if(mState == RenderState::error) mRenderError = text;
+    const bool done = mState == RenderState::none ||
+                      mState == RenderState::error ||
+                      mState == RenderState::finished;
+    if(done && mRenderTimer.isValid()) {
+        mRenderElapsed = mRenderTimer.elapsed();
+        mRenderTimer.invalidate();
+        // the counters are shared, the next render resets them
+        mStageNsecs.clear();
+        for(int i = 0; i < static_cast<int>(RenderStats::Stage::count); i++) {
+            mStageNsecs << RenderStats::sNsecs(static_cast<RenderStats::Stage>(i));
+        }
+        mPeakMemory = RenderStats::sPeakMemory();
+    }
     //if(mState == FINISHED) QSound::play(":/");
     emit stateChanged(mState);
 }
@@ -213,3 +236,67 @@ void RenderInstanceSettings::read(eReadStream &src) {
 
     emit stateChanged(mState);
 }
+
+int RenderInstanceSettings::renderedFrames() const {
+    const int total = mRenderSettings.fMaxFrame - mRenderSettings.fMinFrame + 1;
+    if(mState == RenderState::finished) return total;
+    return qBound(0, mCurrentRenderFrame - mRenderSettings.fMinFrame + 1, total);
+}
+
+qint64 RenderInstanceSettings::renderElapsed() const {
+    return mRenderTimer.isValid() ? mRenderTimer.elapsed() : mRenderElapsed;
+}
+
+qreal RenderInstanceSettings::renderFps() const {
+    const qint64 elapsed = renderElapsed();
+    return elapsed > 0 ? renderedFrames()*1000./elapsed : 0;
+}
+
+int RenderInstanceSettings::renderEta() const {
+    const qreal fps = renderFps();
+    if(fps <= 0) return -1;
+    const int total = mRenderSettings.fMaxFrame - mRenderSettings.fMinFrame + 1;
+    return qRound((total - renderedFrames())/fps);
+}
+
+QJsonObject RenderInstanceSettings::renderStats() const {
+    const bool live = mRenderTimer.isValid();
+    QJsonObject stages;
+    for(int i = 0; i < static_cast<int>(RenderStats::Stage::count); i++) {
+        const auto stage = static_cast<RenderStats::Stage>(i);
+        const qint64 nsecs = live ? RenderStats::sNsecs(stage) :
+                                    mStageNsecs.value(i);
+        stages.insert(RenderStats::sStageName(stage), nsecs/1000000);
+    }
+    const qint64 peakMemory = live ? RenderStats::sPeakMemory() : mPeakMemory;
+    const auto format = mOutputSettings.fOutputFormat;
+    QJsonObject stats;
+    stats.insert("scene", mTargetCanvas ? mTargetCanvas->prp_getName() : QString());
+    stats.insert("output", mOutputDestination);
+    stats.insert("format", format ? QString(format->name) : QString());
+    stats.insert("width", mRenderSettings.fVideoWidth);
+    stats.insert("height", mRenderSettings.fVideoHeight);
+    stats.insert("firstFrame", mRenderSettings.fMinFrame);
+    stats.insert("lastFrame", mRenderSettings.fMaxFrame);
+    stats.insert("frames", renderedFrames());
+    stats.insert("elapsedMs", renderElapsed());
+    stats.insert("fps", renderFps());
+    stats.insert("threads", eSettings::sCpuThreadsCapped());
+    stats.insert("stageMs", stages);
+    stats.insert("peakMemoryMB", peakMemory/(1024*1024));
+    return stats;
+}
+
+void RenderInstanceSettings::writeRenderStats() const {
+    if(mOutputDestination.isEmpty()) return;
+    if(mOutputDestination.startsWith("pipe:")) return;
+    const QFileInfo info(mOutputDestination);
+    // image sequence patterns have no place in the name
+    QString name = info.fileName().remove(QRegularExpression("%0?\\d*d"));
+    const int extId = name.lastIndexOf('.');
+    if(extId > 0) name.truncate(extId);
+    if(name.isEmpty()) name = "render";
+    QFile file(info.dir().filePath(name + ".render.json"));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+    file.write(QJsonDocument(renderStats()).toJson());
+}
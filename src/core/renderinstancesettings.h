@@ -34,6 +34,10 @@
 #include "Private/esettings.h"
 #include "conncontextptr.h"
 
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVector>
+
 class Canvas;
 
 enum class CORE_EXPORT RenderState {
@@ -70,14 +74,32 @@ public:
     void setOutputSettingsProfile(OutputSettingsProfile *profile);
     OutputSettingsProfile *getOutputSettingsProfile();
 
+    //! @brief Milliseconds spent rendering, so far or in the last render
+    qint64 renderElapsed() const;
+    qreal renderFps() const;
+    //! @brief Estimated seconds left, -1 if not known yet
+    int renderEta() const;
+    //! @brief Throughput, stage times and peak memory of the current
+    //! render, or of the last render of these settings
+    QJsonObject renderStats() const;
+    //! @brief Saves renderStats() next to the output, as name.render.json
+    void writeRenderStats() const;
+
     void write(eWriteStream& dst) const;
     void read(eReadStream& src);
 signals:
     void stateChanged(const RenderState state);
     void renderFrameChanged(const int frame);
 private:
+    int renderedFrames() const;
+
     RenderState mState = RenderState::none;
     int mCurrentRenderFrame = 0;
+    QElapsedTimer mRenderTimer;
+    qint64 mRenderElapsed = 0;
+    // RenderStats of this job, copied when it stops
+    QVector<qint64> mStageNsecs;
+    qint64 mPeakMemory = 0;
 
     QString mOutputDestination;
     QString mRenderError;
@@ -0,0 +1,74 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "renderstats.h"
+
+#include <QAtomicInteger>
+
+static const int sStageCount = static_cast<int>(RenderStats::Stage::count);
+static QAtomicInteger<qint64> sStageNsecs[sStageCount];
+static QAtomicInteger<qint64> sPeakBytes = 0;
+
+RenderStats::Timer::Timer(const Stage stage) : mStage(stage) {
+    mTimer.start();
+}
+
+RenderStats::Timer::~Timer() {
+    sAdd(mStage, mTimer.nsecsElapsed());
+}
+
+void RenderStats::sReset() {
+    for(auto& nsecs : sStageNsecs) nsecs.storeRelaxed(0);
+    sPeakBytes.storeRelaxed(0);
+}
+
+void RenderStats::sAdd(const Stage stage, const qint64 nsecs) {
+    sStageNsecs[static_cast<int>(stage)].fetchAndAddRelaxed(nsecs);
+}
+
+void RenderStats::sMemoryUsed(const qint64 bytes) {
+    qint64 peak = sPeakBytes.loadRelaxed();
+    while(bytes > peak && !sPeakBytes.testAndSetRelaxed(peak, bytes, peak));
+}
+
+qint64 RenderStats::sNsecs(const Stage stage) {
+    return sStageNsecs[static_cast<int>(stage)].loadRelaxed();
+}
+
+qint64 RenderStats::sPeakMemory() {
+    return sPeakBytes.loadRelaxed();
+}
+
+QString RenderStats::sStageName(const Stage stage) {
+    switch(stage) {
+    case Stage::setup: return "setup";
+    case Stage::cpu: return "cpu";
+    case Stage::gpu: return "gpu";
+    case Stage::effects: return "effects";
+    case Stage::hddBusy: return "hddBusy";
+    case Stage::conversion: return "conversion";
+    case Stage::encoding: return "encoding";
+    case Stage::muxing: return "muxing";
+    default: return QString();
+    }
+}
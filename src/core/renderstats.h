@@ -0,0 +1,68 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include "core_global.h"
+
+#include <QElapsedTimer>
+#include <QString>
+
+//! @brief Time spent per stage and peak memory of the current output
+//! render. Stage times are summed over all threads, stages running in
+//! parallel add up to more than the wall time.
+class CORE_EXPORT RenderStats {
+public:
+    enum class Stage {
+        setup, // BoxRenderData::setupRenderData
+        cpu, // cpu task threads
+        gpu, // gpu task thread
+        effects, // cpu raster effects, included in cpu
+        hddBusy, // file loading thread busy time, not time waited for it
+        conversion, // output colour conversion, included in encoding
+        encoding, // encode thread
+        muxing, // writing encoded packets, included in encoding
+        count
+    };
+
+    //! @brief Adds the time until it goes out of scope to stage
+    class CORE_EXPORT Timer {
+    public:
+        Timer(const Stage stage);
+        ~Timer();
+    private:
+        const Stage mStage;
+        QElapsedTimer mTimer;
+    };
+
+    static void sReset();
+    static void sAdd(const Stage stage, const qint64 nsecs);
+    static void sMemoryUsed(const qint64 bytes);
+
+    static qint64 sNsecs(const Stage stage);
+    static qint64 sPeakMemory();
+    static QString sStageName(const Stage stage);
+};
+
+#endif // RENDERSTATS_H
@@ -0,0 +1,203 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "segmentmuxer.h"
+#include "avhelpers.h"
+
+#include <QVector>
+#include <cstring>
+
+struct SegmentInput {
+    ~SegmentInput() {
+        if(fCtx) avformat_close_input(&fCtx);
+    }
+
+    void open(const QByteArray &path) {
+        int ret = avformat_open_input(&fCtx, path.constData(),
+                                      nullptr, nullptr);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not open " +
+                                    QString::fromUtf8(path))
+        ret = avformat_find_stream_info(fCtx, nullptr);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not find stream info in " +
+                                    QString::fromUtf8(path))
+    }
+
+    AVFormatContext *fCtx = nullptr;
+};
+
+struct SegmentOutput {
+    ~SegmentOutput() {
+        if(!fCtx) return;
+        if(fCtx->pb && !(fCtx->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&fCtx->pb);
+        }
+        avformat_free_context(fCtx);
+    }
+
+    AVFormatContext *fCtx = nullptr;
+};
+
+// the first segment's extradata is the only one written to the output
+static bool sameParameters(const AVCodecParameters * const a,
+                           const AVCodecParameters * const b)
+{
+    if(a->codec_type != b->codec_type || a->codec_id != b->codec_id ||
+       a->format != b->format) return false;
+    if(a->width != b->width || a->height != b->height) return false;
+    if(a->sample_rate != b->sample_rate || a->channels != b->channels ||
+       a->channel_layout != b->channel_layout) return false;
+    if(a->extradata_size != b->extradata_size) return false;
+    return a->extradata_size == 0 ||
+           memcmp(a->extradata, b->extradata, size_t(a->extradata_size)) == 0;
+}
+
+struct SegmentPacket {
+    SegmentPacket() : fPkt(av_packet_alloc()) {
+        if(!fPkt) RuntimeThrow("Could not allocate packet");
+    }
+    ~SegmentPacket() { av_packet_free(&fPkt); }
+
+    AVPacket *fPkt;
+};
+
+void SegmentMuxer::sConcat(const QStringList &segments,
+                           const QString &dst,
+                           const AVOutputFormat *format)
+{
+    if(segments.isEmpty()) RuntimeThrow("No segments to concatenate");
+    const QByteArray dstPath = dst.toUtf8();
+
+    SegmentInput first;
+    first.open(segments.first().toUtf8());
+    const uint nStreams = first.fCtx->nb_streams;
+
+    SegmentOutput output;
+    int ret = avformat_alloc_output_context2(&output.fCtx,
+                                             const_cast<AVOutputFormat*>(format),
+                                             nullptr, dstPath.constData());
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not allocate output context")
+    const auto oc = output.fCtx;
+    av_dict_copy(&oc->metadata, first.fCtx->metadata, 0);
+
+    for(uint i = 0; i < nStreams; i++) {
+        const auto inStream = first.fCtx->streams[i];
+        const auto outStream = avformat_new_stream(oc, nullptr);
+        if(!outStream) RuntimeThrow("Could not alloc stream");
+        ret = avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not copy the stream parameters")
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        outStream->avg_frame_rate = inStream->avg_frame_rate;
+    }
+
+    if(!(oc->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&oc->pb, dstPath.constData(), AVIO_FLAG_WRITE);
+        if(ret < 0) AV_RuntimeThrow(ret, "Could not open " + dst)
+    }
+    ret = avformat_write_header(oc, nullptr);
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not write header to " + dst)
+
+    // segments are placed by the end of their video, audio runs longer
+    // because of encoder priming and padding and would shift the video
+    int videoStream = -1;
+    for(uint i = 0; i < nStreams; i++) {
+        if(first.fCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            videoStream = int(i);
+            break;
+        }
+    }
+
+    // each segment starts where the previous one ended (AV_TIME_BASE),
+    // dts is kept strictly increasing across segment boundaries
+    int64_t segmentStart = 0;
+    QVector<int64_t> lastDts(int(nStreams), AV_NOPTS_VALUE);
+    SegmentPacket packet;
+    const auto pkt = packet.fPkt;
+
+    for(const auto &segment : segments) {
+        SegmentInput input;
+        input.open(segment.toUtf8());
+        const auto ic = input.fCtx;
+        if(ic->nb_streams != nStreams) {
+            RuntimeThrow("Stream count mismatch in " + segment);
+        }
+        for(uint i = 0; i < nStreams; i++) {
+            if(!sameParameters(ic->streams[i]->codecpar,
+                               oc->streams[i]->codecpar)) {
+                RuntimeThrow("Codec parameters mismatch in " + segment);
+            }
+        }
+
+        QVector<int64_t> shift(int(nStreams), AV_NOPTS_VALUE);
+        int64_t segmentEnd = segmentStart;
+        while(av_read_frame(ic, pkt) >= 0) {
+            const int id = pkt->stream_index;
+            if(id < 0 || id >= int(nStreams)) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            const auto outStream = oc->streams[id];
+            av_packet_rescale_ts(pkt, ic->streams[id]->time_base,
+                                 outStream->time_base);
+            const bool leading = videoStream == -1 || id == videoStream;
+            if(shift[id] == AV_NOPTS_VALUE) {
+                shift[id] = av_rescale_q(segmentStart, AV_TIME_BASE_Q,
+                                         outStream->time_base);
+                const int64_t firstDts = pkt->dts == AV_NOPTS_VALUE ?
+                            pkt->pts : pkt->dts;
+                if(leading && lastDts[id] != AV_NOPTS_VALUE &&
+                   firstDts != AV_NOPTS_VALUE &&
+                   firstDts + shift[id] <= lastDts[id]) {
+                    shift[id] = lastDts[id] + 1 - firstDts;
+                }
+            }
+            // other streams keep their place, packets overlapping the
+            // previous segment's padding are dropped instead
+            if(!leading && pkt->dts != AV_NOPTS_VALUE &&
+               lastDts[id] != AV_NOPTS_VALUE &&
+               pkt->dts + shift[id] <= lastDts[id]) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            if(pkt->pts != AV_NOPTS_VALUE) pkt->pts += shift[id];
+            if(pkt->dts != AV_NOPTS_VALUE) {
+                pkt->dts += shift[id];
+                lastDts[id] = pkt->dts;
+            }
+            if(leading && pkt->pts != AV_NOPTS_VALUE) {
+                const int64_t end = av_rescale_q(pkt->pts + pkt->duration,
+                                                 outStream->time_base,
+                                                 AV_TIME_BASE_Q);
+                segmentEnd = qMax(segmentEnd, end);
+            }
+            pkt->pos = -1;
+            ret = av_interleaved_write_frame(oc, pkt);
+            av_packet_unref(pkt);
+            if(ret < 0) AV_RuntimeThrow(ret, "Error while writing packet")
+        }
+        segmentStart = segmentEnd;
+    }
+
+    ret = av_write_trailer(oc);
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not write trailer to " + dst)
+}
@@ -0,0 +1,46 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef SEGMENTMUXER_H
+#define SEGMENTMUXER_H
+
+#include "core_global.h"
+
+#include <QStringList>
+
+extern "C" {
+    #include <libavformat/avformat.h>
+}
+
+//! @brief Joins segments written with the same OutputSettings
+//! (e.g. by chunked rendering) by remuxing, without re-encoding.
+class CORE_EXPORT SegmentMuxer {
+public:
+    //! @brief Throws if a segment has different streams or codec parameters
+    //! than the first one.
+    static void sConcat(const QStringList &segments,
+                        const QString &dst,
+                        const AVOutputFormat *format = nullptr);
+};
+
+#endif // SEGMENTMUXER_H
@@ -0,0 +1,256 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#include "swscontextcache.h"
+
+#include "Private/esettings.h"
+#include "Private/Tasks/taskexecutor.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+
+extern "C" {
+    #include <libavutil/pixdesc.h>
+    #include <libavutil/imgutils.h>
+    #include <libswscale/swscale.h>
+}
+
+struct SwsCacheEntry {
+    SwsContextCache::Conversion fConv;
+    QList<SwsContext*> fIdle;
+    quint64 fLastUse = 0;
+};
+
+static QMutex sMutex;
+static QList<SwsCacheEntry> sEntries;
+static quint64 sUseCounter = 0;
+// conversions with idle contexts kept around
+static const int sMaxEntries = 32;
+// rows below which a slice is not worth its own task
+static const int sMinSliceRows = 128;
+// source rows converted above and below every slice and then discarded,
+// covers the vertical filters so slices match a whole frame conversion
+static const int sSliceOverlap = 32;
+
+bool SwsContextCache::Conversion::operator==(const Conversion& other) const {
+    return fSrcFormat == other.fSrcFormat &&
+           fSrcWidth == other.fSrcWidth &&
+           fSrcHeight == other.fSrcHeight &&
+           fDstFormat == other.fDstFormat &&
+           fDstWidth == other.fDstWidth &&
+           fDstHeight == other.fDstHeight &&
+           fFlags == other.fFlags;
+}
+
+SwsContext* SwsContextCache::sAcquire(const Conversion& conv) {
+    {
+        QMutexLocker lock(&sMutex);
+        for(auto& entry : sEntries) {
+            if(!(entry.fConv == conv) || entry.fIdle.isEmpty()) continue;
+            return entry.fIdle.takeLast();
+        }
+    }
+    return sws_getContext(conv.fSrcWidth, conv.fSrcHeight, conv.fSrcFormat,
+                          conv.fDstWidth, conv.fDstHeight, conv.fDstFormat,
+                          conv.fFlags, nullptr, nullptr, nullptr);
+}
+
+void SwsContextCache::sRelease(const Conversion& conv,
+                               SwsContext* const context) {
+    QList<SwsContext*> evicted;
+    {
+        QMutexLocker lock(&sMutex);
+        SwsCacheEntry* target = nullptr;
+        for(auto& entry : sEntries) {
+            if(entry.fConv == conv) {
+                target = &entry;
+                break;
+            }
+        }
+        if(!target) {
+            if(sEntries.count() >= sMaxEntries) {
+                int oldest = 0;
+                for(int i = 1; i < sEntries.count(); i++) {
+                    if(sEntries.at(i).fLastUse < sEntries.at(oldest).fLastUse)
+                        oldest = i;
+                }
+                evicted << sEntries.takeAt(oldest).fIdle;
+            }
+            sEntries.append(SwsCacheEntry{conv, {}, 0});
+            target = &sEntries.last();
+        }
+        target->fLastUse = ++sUseCounter;
+        if(target->fIdle.count() < eSettings::sCpuThreadsCapped()) {
+            target->fIdle << context;
+        } else evicted << context;
+    }
+    for(const auto ctx : evicted) sws_freeContext(ctx);
+}
+
+void SwsContextCache::sClear() {
+    QList<SwsContext*> evicted;
+    {
+        QMutexLocker lock(&sMutex);
+        for(const auto& entry : sEntries) evicted << entry.fIdle;
+        sEntries.clear();
+    }
+    for(const auto ctx : evicted) sws_freeContext(ctx);
+}
+
+bool SwsContextCache::sScaleWhole(const Conversion& conv,
+                                  const uint8_t* const src[],
+                                  const int srcStride[],
+                                  uint8_t* const dst[],
+                                  const int dstStride[]) {
+    const auto context = sAcquire(conv);
+    if(!context) return false;
+    sws_scale(context, src, srcStride, 0, conv.fSrcHeight, dst, dstStride);
+    sRelease(conv, context);
+    return true;
+}
+
+int SwsContextCache::sSliceAlignment(const Conversion& conv) {
+    if(conv.fSrcWidth != conv.fDstWidth ||
+       conv.fSrcHeight != conv.fDstHeight) return 0;
+    const auto srcDesc = av_pix_fmt_desc_get(conv.fSrcFormat);
+    const auto dstDesc = av_pix_fmt_desc_get(conv.fDstFormat);
+    if(!srcDesc || !dstDesc) return 0;
+    const auto excluded = AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL |
+                          AV_PIX_FMT_FLAG_BITSTREAM;
+    if((srcDesc->flags | dstDesc->flags) & excluded) return 0;
+    // slices start on whole chroma rows and keep the row phase of the
+    // ordered dither (8 rows), the chroma scale is only the same as for
+    // the whole frame if the height is a whole number of chroma rows
+    const int chroma = 1 << qMax(srcDesc->log2_chroma_h, dstDesc->log2_chroma_h);
+    if(conv.fSrcHeight % chroma) return 0;
+    return qMax(chroma, 8);
+}
+
+//! @brief Slices claimed one at a time by the caller and helper tasks
+struct SwsSlices {
+    std::function<bool(const int)> fConvert;
+    int fCount = 0;
+    QAtomicInt fNext = 0;
+    QAtomicInt fFailed = 0;
+    QMutex fMutex;
+    QWaitCondition fFinished;
+    int fDone = 0;
+
+    void convertRemaining() {
+        while(true) {
+            const int slice = fNext.fetchAndAddOrdered(1);
+            if(slice >= fCount) return;
+            if(!fConvert(slice)) fFailed.storeRelease(1);
+            QMutexLocker lock(&fMutex);
+            if(++fDone == fCount) fFinished.wakeAll();
+        }
+    }
+};
+
+static void offsetPlanes(const AVPixelFormat format, const int row,
+                         const uint8_t* const src[], const int stride[],
+                         const uint8_t* dst[4]) {
+    const auto desc = av_pix_fmt_desc_get(format);
+    const int planes = av_pix_fmt_count_planes(format);
+    for(int i = 0; i < 4; i++) {
+        if(i >= planes || !src[i]) {
+            dst[i] = nullptr;
+            continue;
+        }
+        const bool chroma = i == 1 || i == 2;
+        const int planeRow = chroma ? row >> desc->log2_chroma_h : row;
+        dst[i] = src[i] + planeRow*stride[i];
+    }
+}
+
+bool SwsContextCache::sScale(const Conversion& conv,
+                             const uint8_t* const src[],
+                             const int srcStride[],
+                             uint8_t* const dst[], const int dstStride[]) {
+    const int alignment = sSliceAlignment(conv);
+    const int height = conv.fSrcHeight;
+    const int maxSlices = alignment ? height/sMinSliceRows : 1;
+    const int count = qMin(eSettings::sCpuThreadsCapped(), maxSlices);
+    if(count <= 1) return sScaleWhole(conv, src, srcStride, dst, dstStride);
+
+    int sliceRows = (height + count - 1)/count;
+    sliceRows = (sliceRows + alignment - 1)/alignment*alignment;
+    const auto slices = std::make_shared<SwsSlices>();
+    slices->fCount = (height + sliceRows - 1)/sliceRows;
+    slices->fConvert = [&](const int slice) {
+        const int row = slice*sliceRows;
+        const int rows = qMin(sliceRows, height - row);
+        const int padRow = qMax(0, row - sSliceOverlap);
+        const int padRows = qMin(height, row + rows + sSliceOverlap) - padRow;
+        Conversion sliceConv = conv;
+        sliceConv.fSrcHeight = padRows;
+        sliceConv.fDstHeight = padRows;
+        const uint8_t* sliceSrc[4];
+        offsetPlanes(conv.fSrcFormat, padRow, src, srcStride, sliceSrc);
+        // the overlap belongs to the neighbouring slices,
+        // convert to a scratch buffer and copy the own rows only
+        uint8_t* tmp[4];
+        int tmpStride[4];
+        if(av_image_alloc(tmp, tmpStride, conv.fDstWidth, padRows,
+                          conv.fDstFormat, 64) < 0) return false;
+        const bool scaled = sScaleWhole(sliceConv, sliceSrc, srcStride,
+                                        tmp, tmpStride);
+        if(scaled) {
+            const uint8_t* own[4];
+            offsetPlanes(conv.fDstFormat, row - padRow,
+                         const_cast<const uint8_t* const*>(tmp), tmpStride,
+                         own);
+            const uint8_t* sliceDst[4];
+            offsetPlanes(conv.fDstFormat, row,
+                         const_cast<const uint8_t* const*>(dst), dstStride,
+                         sliceDst);
+            const auto desc = av_pix_fmt_desc_get(conv.fDstFormat);
+            for(int i = 0; i < 4 && own[i]; i++) {
+                const bool chroma = i == 1 || i == 2;
+                const int planeRows = chroma ? rows >> desc->log2_chroma_h : rows;
+                av_image_copy_plane(const_cast<uint8_t*>(sliceDst[i]), dstStride[i],
+                                    own[i], tmpStride[i],
+                                    av_image_get_linesize(conv.fDstFormat,
+                                                          conv.fDstWidth, i),
+                                    planeRows);
+            }
+        }
+        av_freep(&tmp[0]);
+        return scaled;
+    };
+    // helpers find nothing left to do if they start after the caller is done
+    for(int i = 1; i < slices->fCount; i++) {
+        const auto helper = enve::make_shared<eCustomCpuTask>(
+                    nullptr, [slices]() { slices->convertRemaining(); },
+                    nullptr, nullptr);
+        CpuTaskExecutor::sAddTask(helper);
+    }
+    slices->convertRemaining();
+    {
+        QMutexLocker lock(&slices->fMutex);
+        while(slices->fDone < slices->fCount) {
+            slices->fFinished.wait(&slices->fMutex);
+        }
+    }
+    return !slices->fFailed.loadAcquire();
+}
@@ -0,0 +1,71 @@
+/*
+#
+# Friction - https://friction.graphics
+#
+# Copyright (c) Ole-André Rodlie and contributors
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# See 'README.md' for more information.
+#
+*/
+
+#ifndef SWSCONTEXTCACHE_H
+#define SWSCONTEXTCACHE_H
+
+#include "core_global.h"
+
+#include <QtGlobal>
+
+extern "C" {
+    #include <libavutil/pixfmt.h>
+}
+
+struct SwsContext;
+
+//! @brief Pool of swscale contexts shared by all threads and reused
+//! across frames, keyed by the conversion. Conversions that keep the size
+//! are split into overlapping horizontal slices converted in parallel on
+//! the CPU pool, with the same result as a whole frame conversion.
+class CORE_EXPORT SwsContextCache {
+public:
+    struct Conversion {
+        AVPixelFormat fSrcFormat;
+        int fSrcWidth;
+        int fSrcHeight;
+        AVPixelFormat fDstFormat;
+        int fDstWidth;
+        int fDstHeight;
+        int fFlags;
+
+        bool operator==(const Conversion& other) const;
+    };
+
+    //! @brief Converts src to dst, returns false if the conversion is not
+    //! supported. Safe to call from any thread.
+    static bool sScale(const Conversion& conv,
+                       const uint8_t* const src[], const int srcStride[],
+                       uint8_t* const dst[], const int dstStride[]);
+    //! @brief Frees all contexts not in use
+    static void sClear();
+private:
+    static SwsContext* sAcquire(const Conversion& conv);
+    static void sRelease(const Conversion& conv, SwsContext* const context);
+    static bool sScaleWhole(const Conversion& conv,
+                            const uint8_t* const src[], const int srcStride[],
+                            uint8_t* const dst[], const int dstStride[]);
+    static int sSliceAlignment(const Conversion& conv);
+};
+
+#endif // SWSCONTEXTCACHE_H
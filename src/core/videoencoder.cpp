@@ -28,45 +28,67 @@
 #include "Boxes/boxrendercontainer.h"
 #include "CacheHandlers/sceneframecontainer.h"
 #include "canvas.h"
-
-#define AV_RuntimeThrow(errId, message) \
-{ \
-    char * const errMsg = new char[AV_ERROR_MAX_STRING_SIZE]; \
-    av_make_error_string(errMsg, AV_ERROR_MAX_STRING_SIZE, errId); \
-    try { \
-        RuntimeThrow(errMsg); \
-    } catch(...) { \
-        delete[] errMsg; \
-        RuntimeThrow(message); \
-    } \
-}
+#include "Private/esettings.h"
+#include "Private/Tasks/taskscheduler.h"
+#include "imagesequencewriter.h"
+#include "swscontextcache.h"
+#include "renderstats.h"
+#include "avhelpers.h"
 
 using namespace Friction::Core;
 
 VideoEncoder *VideoEncoder::sInstance = nullptr;
 
-VideoEncoder::VideoEncoder() {
+VideoEncoder::VideoEncoder(const bool extraOutput) :
+    mExtraOutput(extraOutput) {
+    if(mExtraOutput) return;
     Q_ASSERT(!sInstance);
     sInstance = this;
 }
 
 void VideoEncoder::addContainer(const stdsptr<SceneFrameContainer>& cont) {
     if(!cont) return;
+    for(const auto& output : mOutputs) output->addContainer(cont);
     mNextContainers.append(cont);
     if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
 }
 
 void VideoEncoder::addContainer(const stdsptr<Samples>& cont) {
     if(!cont) return;
+    // outputs without audio would only pile up the samples
+    for(const auto& output : mOutputs) {
+        if(output->mEncodeAudio) output->addContainer(cont);
+    }
     mNextSoundConts.append(cont);
     if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
 }
 
 void VideoEncoder::allAudioProvided() {
+    for(const auto& output : mOutputs) output->allAudioProvided();
     mAllAudioProvided = true;
     if(getState() < eTaskState::qued || getState() > eTaskState::processing) queTask();
 }
 
+void VideoEncoder::queTaskNow() {
+    TaskScheduler::instance()->queEncodeTask(ref<eTask>());
+}
+
+int VideoEncoder::queuedFrames() const {
+    int queued = mNextContainers.count() + _mContainers.count();
+    // rendering waits for the slowest output
+    for(const auto& output : mOutputs) {
+        if(!output->mCurrentlyEncoding) continue;
+        queued = qMax(queued, output->queuedFrames());
+    }
+    return queued;
+}
+
+bool VideoEncoder::sEncodeQueueFull() {
+    if(!sInstance->mCurrentlyEncoding) return false;
+    const int maxQueued = qMax(4, 2*eSettings::sCpuThreadsCapped());
+    return sInstance->queuedFrames() >= maxQueued;
+}
+
 bool VideoEncoder::isValidProfile(const AVCodec *codec,
                                   int profile)
 {
@@ -136,6 +158,12 @@ bool VideoEncoder::isValidProfile(const AVCodec *codec,
     return false;
 }
 
+static int interleavedWriteFrame(AVFormatContext * const oc,
+                                 AVPacket * const pkt) {
+    const RenderStats::Timer timer(RenderStats::Stage::muxing);
+    return av_interleaved_write_frame(oc, pkt);
+}
+
 static AVFrame *allocPicture(enum AVPixelFormat pix_fmt,
                              const int width, const int height) {
     AVFrame * const picture = av_frame_alloc();
@@ -244,59 +272,75 @@ static void addVideoStream(OutputStream * const ost,
     if(oc->oformat->flags & AVFMT_GLOBALHEADER) {
         c->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
     }
+    // let the codec use its own frame/slice threads
+    c->thread_count = eSettings::sCpuThreadsCapped();
+    c->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 }
 
-static AVFrame *getVideoFrame(OutputStream * const ost,
-                              const sk_sp<SkImage> &image) {
-    AVCodecContext *c = ost->fCodec;
-
-    /* check if we want to generate more frames */
-//    if(av_compare_ts(ost->next_pts, c->time_base,
-//                      STREAM_DURATION, (AVRational) { 1, 1 }) >= 0)
-//        return nullptr;
-
-    /* as we only generate a rgba picture, we must convert it
-     * to the codec pixel format if needed */
-    if(!ost->fSwsCtx) {
-        ost->fSwsCtx = sws_getContext(c->width, c->height,
-                                      AV_PIX_FMT_RGBA,
-                                      c->width, c->height,
-                                      c->pix_fmt, SWS_BICUBIC,
-                                      nullptr, nullptr, nullptr);
-        if(!ost->fSwsCtx)
-            RuntimeThrow("Cannot initialize the conversion context");
-    }
+void VideoEncoder::sConvertFrame(const sk_sp<SkImage> &image,
+                                 const AVCodecContext * const codec,
+                                 AVFrame * const frame,
+                                 SkBitmap &unpremul) {
+    const RenderStats::Timer timer(RenderStats::Stage::conversion);
     SkPixmap pixmap;
     image->peekPixels(&pixmap);
 
     // check if we need to convert to "unpremultiplied"
-    const bool unpremul = c->codec_id == AV_CODEC_ID_PNG; // for now only check for PNG
-    if (unpremul) {
-        SkImageInfo unpremulInfo = SkImageInfo::Make(pixmap.width(),
-                                                     pixmap.height(),
-                                                     kRGBA_8888_SkColorType,
-                                                     kUnpremul_SkAlphaType,
-                                                     pixmap.info().refColorSpace());
-        SkBitmap unpremulBitmap;
-        if (unpremulBitmap.tryAllocPixels(unpremulInfo)) {
+    if(codec->codec_id == AV_CODEC_ID_PNG) { // for now only check for PNG
+        const SkImageInfo unpremulInfo = SkImageInfo::Make(pixmap.width(),
+                                                           pixmap.height(),
+                                                           kRGBA_8888_SkColorType,
+                                                           kUnpremul_SkAlphaType,
+                                                           pixmap.info().refColorSpace());
+        if(unpremul.info() != unpremulInfo) {
+            if(!unpremul.tryAllocPixels(unpremulInfo)) unpremul.reset();
+        }
+        if(!unpremul.isNull()) {
             const bool converted = image->readPixels(unpremulInfo,
-                                                     unpremulBitmap.getPixels(),
-                                                     unpremulBitmap.rowBytes(),
+                                                     unpremul.getPixels(),
+                                                     unpremul.rowBytes(),
                                                      0, 0);
-            if (converted) { unpremulBitmap.peekPixels(&pixmap); }
+            if(converted) unpremul.peekPixels(&pixmap);
         }
     }
 
-    const uint8_t * const dstSk[] = {static_cast<uint8_t*>(pixmap.writable_addr())};
-    int linesizesSk[4];
+    const uint8_t * const srcData[4] = {static_cast<uint8_t*>(pixmap.writable_addr())};
+    const int srcLinesize[4] = {static_cast<int>(pixmap.rowBytes())};
 
-    av_image_fill_linesizes(linesizesSk, AV_PIX_FMT_RGBA, image->width());
-    const int ret = av_frame_make_writable(ost->fDstFrame) ;
+    const int ret = av_frame_make_writable(frame);
     if(ret < 0) AV_RuntimeThrow(ret, "Could not make AVFrame writable")
 
-    sws_scale(ost->fSwsCtx, dstSk,
-              linesizesSk, 0, c->height, ost->fDstFrame->data,
-              ost->fDstFrame->linesize);
+    // in slices on the cpu threads, scaled if the frame was rendered
+    // for a larger output sharing the render
+    const SwsContextCache::Conversion conv{AV_PIX_FMT_RGBA,
+                                           pixmap.width(), pixmap.height(),
+                                           codec->pix_fmt,
+                                           codec->width, codec->height,
+                                           SWS_BICUBIC};
+    const bool scaled = SwsContextCache::sScale(conv, srcData, srcLinesize,
+                                                frame->data, frame->linesize);
+    if(!scaled) RuntimeThrow("Cannot initialize the conversion context");
+}
+
+static AVFrame *getVideoFrame(OutputStream * const ost,
+                              const sk_sp<SkImage> &image) {
+    AVCodecContext *c = ost->fCodec;
+
+    /* check if we want to generate more frames */
+//    if(av_compare_ts(ost->next_pts, c->time_base,
+//                      STREAM_DURATION, (AVRational) { 1, 1 }) >= 0)
+//        return nullptr;
+
+    // frames held over several output frames are converted only once,
+    // the encoder keeps its own reference so the data is still intact
+    if(ost->fConverted == image) {
+        ost->fDstFrame->pts = ost->fNextPts++;
+        return ost->fDstFrame;
+    }
+    ost->fConverted.reset();
+
+    VideoEncoder::sConvertFrame(image, c, ost->fDstFrame, ost->fUnpremul);
+    ost->fConverted = image;
 
     ost->fDstFrame->pts = ost->fNextPts++;
 
@@ -331,7 +375,7 @@ static void writeVideoFrame(AVFormatContext * const oc,
             pkt.stream_index = ost->fStream->index;
 
             // Write the compressed frame to the media file.
-            const int interRet = av_interleaved_write_frame(oc, &pkt);
+            const int interRet = interleavedWriteFrame(oc, &pkt);
             if(interRet < 0) AV_RuntimeThrow(interRet, "Error while writing video frame")
         } else if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) {
             *encodeVideo = ret != AVERROR_EOF;
@@ -485,7 +529,7 @@ static void encodeAudioFrame(AVFormatContext * const oc,
             pkt.stream_index = ost->fStream->index;
 
             /* Write the compressed frame to the media file. */
-            const int interRet = av_interleaved_write_frame(oc, &pkt);
+            const int interRet = interleavedWriteFrame(oc, &pkt);
             if(interRet < 0) AV_RuntimeThrow(interRet, "Error while writing audio frame")
         } else if(recRet == AVERROR(EAGAIN) || recRet == AVERROR_EOF) {
             *encodeAudio = recRet == AVERROR(EAGAIN);
@@ -500,6 +544,9 @@ static void processAudioStream(AVFormatContext * const oc,
                                OutputStream * const ost,
                                SoundIterator &iterator,
                                bool * const audioEnabled) {
+    // the encoder may still hold a reference to the previous samples
+    const int ret = av_frame_make_writable(ost->fSrcFrame);
+    if(ret < 0) AV_RuntimeThrow(ret, "Could not make audio frame writable")
     iterator.fillFrame(ost->fSrcFrame);
     bool gotOutput = ost->fSrcFrame;
 
@@ -543,6 +590,7 @@ void VideoEncoder::startEncodingNow() {
     mFormatContext->url = av_strdup(mPathByteArray.constData());
 
     _mCurrentContainerFrame = 0;
+    mImageWriter.reset();
     // add streams
     mAllAudioProvided = false;
     mEncodeVideo = false;
@@ -559,10 +607,13 @@ void VideoEncoder::startEncodingNow() {
     const auto soundComp = scene->getSoundComposition();
     if(mOutputFormat->audio_codec != AV_CODEC_ID_NONE &&
        mOutputSettings.fAudioEnabled && soundComp->hasAnySounds()) {
-        eSoundSettings::sSave();
-        eSoundSettings::sSetSampleRate(mOutputSettings.fAudioSampleRate);
-        eSoundSettings::sSetSampleFormat(mOutputSettings.fAudioSampleFormat);
-        eSoundSettings::sSetChannelLayout(mOutputSettings.fAudioChannelsLayout);
+        // extra outputs take the samples set up for the lead output
+        if(!mExtraOutput) {
+            eSoundSettings::sSave();
+            eSoundSettings::sSetSampleRate(mOutputSettings.fAudioSampleRate);
+            eSoundSettings::sSetSampleFormat(mOutputSettings.fAudioSampleFormat);
+            eSoundSettings::sSetChannelLayout(mOutputSettings.fAudioChannelsLayout);
+        }
         mInSoundSettings = eSoundSettings::sData();
         try {
             addAudioStream(&mAudioStream, mFormatContext, mOutputSettings,
@@ -580,6 +631,12 @@ void VideoEncoder::startEncodingNow() {
         } catch (...) {
             RuntimeThrow("Error opening video stream");
         }
+        // image sequence frames are independent, encode them in parallel
+        if(ImageSequenceWriter::sSupported(mOutputFormat, mOutputSettings,
+                                           mPathByteArray)) {
+            mImageWriter = enve::make_shared<ImageSequenceWriter>(
+                        mVideoStream.fCodec, mOutputSettings, mPathByteArray);
+        }
     }
     if(mEncodeAudio) {
         try {
@@ -607,6 +664,8 @@ void VideoEncoder::startEncodingNow() {
 bool VideoEncoder::startEncoding(RenderInstanceSettings * const settings) {
     if(mCurrentlyEncoding) return false;
     mRenderInstanceSettings = settings;
+    // extra outputs share the stats of the render
+    if(!mExtraOutput) RenderStats::sReset();
     mRenderInstanceSettings->renderingAboutToStart();
     mOutputSettings = mRenderInstanceSettings->getOutputRenderSettings();
     mRenderSettings = mRenderInstanceSettings->getRenderSettings();
@@ -629,6 +688,57 @@ bool VideoEncoder::startEncoding(RenderInstanceSettings * const settings) {
     }
 }
 
+bool VideoEncoder::addOutput(RenderInstanceSettings * const settings) {
+    if(!mCurrentlyEncoding || mExtraOutput) return false;
+    if(!sCanShareRender(*mRenderInstanceSettings, *settings)) return false;
+    const auto output = enve::make_shared<VideoEncoder>(true);
+    if(!output->startEncoding(settings)) return false;
+    mOutputs << output;
+    return true;
+}
+
+static const AVOutputFormat *outputFormat(const RenderInstanceSettings &settings) {
+    const auto format = settings.getOutputRenderSettings().fOutputFormat;
+    if(format) return format;
+    const auto path = settings.getOutputDestination().toUtf8();
+    return av_guess_format(nullptr, path.constData(), nullptr);
+}
+
+static bool encodesAudio(const RenderInstanceSettings &settings) {
+    const auto format = outputFormat(settings);
+    if(!format || format->audio_codec == AV_CODEC_ID_NONE) return false;
+    return settings.getOutputRenderSettings().fAudioEnabled;
+}
+
+bool VideoEncoder::sCanShareRender(const RenderInstanceSettings &lead,
+                                   const RenderInstanceSettings &output) {
+    if(&lead == &output) return false;
+    const auto scene = lead.getTargetCanvas();
+    if(!scene || scene != output.getTargetCanvas()) return false;
+    const auto& leadRender = lead.getRenderSettings();
+    const auto& outRender = output.getRenderSettings();
+    if(leadRender.fMinFrame != outRender.fMinFrame ||
+       leadRender.fMaxFrame != outRender.fMaxFrame) return false;
+    if(av_cmp_q(leadRender.fTimeBase, outRender.fTimeBase)) return false;
+    // frames are rendered for the lead and scaled down for the output
+    const qint64 leadW = leadRender.fVideoWidth;
+    const qint64 leadH = leadRender.fVideoHeight;
+    const qint64 outW = outRender.fVideoWidth;
+    const qint64 outH = outRender.fVideoHeight;
+    if(outW > leadW || outH > leadH) return false;
+    // same aspect ratio, up to the rounding of the scaled down size,
+    // other shapes would be stretched and are rendered separately
+    if(qAbs(outW*leadH - outH*leadW) > (leadW + leadH)/2) return false;
+    if(!encodesAudio(output)) return true;
+    if(!encodesAudio(lead)) return false;
+    // samples are rendered once, in the format of the lead
+    const auto& leadOut = lead.getOutputRenderSettings();
+    const auto& outOut = output.getOutputRenderSettings();
+    return leadOut.fAudioSampleRate == outOut.fAudioSampleRate &&
+           leadOut.fAudioSampleFormat == outOut.fAudioSampleFormat &&
+           leadOut.fAudioChannelsLayout == outOut.fAudioChannelsLayout;
+}
+
 void VideoEncoder::interrupEncoding() {
     if(!mCurrentlyEncoding) return;
     mRenderInstanceSettings->setCurrentState(RenderState::none, "Interrupted");
@@ -637,7 +747,27 @@ void VideoEncoder::interrupEncoding() {
 }
 
 void VideoEncoder::finishEncodingSuccess() {
+    if(mImageWriter && mImageWriter->pending()) {
+        // finishes once the qued image sequence frames are written
+        const stdptr<VideoEncoder> ptr = this;
+        mImageWriter->whenDone([ptr]() {
+            if(ptr) ptr->finishEncodingSuccess();
+        });
+        return;
+    }
+    if(mImageWriter) {
+        try {
+            mImageWriter->checkError();
+        } catch(const std::exception& e) {
+            gPrintExceptionCritical(e);
+            mRenderInstanceSettings->setCurrentState(RenderState::error, "Error");
+            finishEncodingNow();
+            mEmitter.encodingFailed();
+            return;
+        }
+    }
     mRenderInstanceSettings->setCurrentState(RenderState::finished);
+    mRenderInstanceSettings->writeRenderStats();
     mEncodingSuccesfull = true;
     finishEncodingNow();
     mEmitter.encodingFinished();
@@ -667,7 +797,7 @@ static void flushStream(OutputStream * const ost,
             pkt.duration = av_rescale_q(pkt.duration, ost->fCodec->time_base,
                                         ost->fStream->time_base);
         pkt.stream_index = ost->fStream->index;
-        ret = av_interleaved_write_frame(formatCtx, &pkt);
+        ret = interleavedWriteFrame(formatCtx, &pkt);
     }
 }
 
@@ -679,18 +809,22 @@ static void closeStream(OutputStream * const ost) {
     }
     if(ost->fDstFrame) av_frame_free(&ost->fDstFrame);
     if(ost->fSrcFrame) av_frame_free(&ost->fSrcFrame);
-    if(ost->fSwsCtx) sws_freeContext(ost->fSwsCtx);
     if(ost->fSwrCtx) swr_free(&ost->fSwrCtx);
     *ost = OutputStream();
 }
 
 void VideoEncoder::finishEncodingNow() {
     if(!mCurrentlyEncoding) return;
+    const bool succeeded = mEncodingSuccesfull;
 
+    if(mImageWriter) {
+        mImageWriter->abort();
+        mImageWriter.reset();
+    }
     if(mEncodeVideo) flushStream(&mVideoStream, mFormatContext);
     if(mEncodeAudio) flushStream(&mAudioStream, mFormatContext);
 
-    if(mEncodingSuccesfull) av_write_trailer(mFormatContext);
+    if(succeeded) av_write_trailer(mFormatContext);
 
     /* Close each codec. */
     if(mEncodeVideo) closeStream(&mVideoStream);
@@ -715,8 +849,13 @@ void VideoEncoder::finishEncodingNow() {
     mNextContainers.clear();
     mNextSoundConts.clear();
     clearContainers();
+    // after a successful render the outputs finish on their own
+    if(!succeeded) {
+        for(const auto& output : mOutputs) output->interruptCurrentEncoding();
+    }
+    mOutputs.clear();
 
-    eSoundSettings::sRestore();
+    if(!mExtraOutput) eSoundSettings::sRestore();
 }
 
 void VideoEncoder::clearContainers() {
@@ -748,9 +887,17 @@ void VideoEncoder::process() {
             const auto contRange = cacheCont->getRange()*_mRenderRange;
             const int nFrames = contRange.span();
             try {
-                writeVideoFrame(mFormatContext, &mVideoStream,
-                                cacheCont->getImage(), &hasVideo);
-                avcodec_flush_buffers(mVideoStream.fCodec);
+                if(mImageWriter) {
+                    mImageWriter->checkError();
+                    // held frames get qued once, see afterProcessing()
+                    const int count = nFrames - _mCurrentContainerFrame;
+                    _mImageFrames << qMakePair(cacheCont->getImage(), count);
+                    mVideoStream.fNextPts += count;
+                    _mCurrentContainerFrame = nFrames - 1;
+                } else {
+                    writeVideoFrame(mFormatContext, &mVideoStream,
+                                    cacheCont->getImage(), &hasVideo);
+                }
             } catch(...) {
                 RuntimeThrow("Failed to write video frame");
             }
@@ -772,7 +919,6 @@ void VideoEncoder::process() {
             try {
                 processAudioStream(mFormatContext, &mAudioStream,
                                    mSoundIterator, &hasAudio);
-                avcodec_flush_buffers(mAudioStream.fCodec);
             } catch(...) {
                 RuntimeThrow("Failed to process audio stream");
             }
@@ -802,11 +948,23 @@ void VideoEncoder::beforeProcessing(const Hardware) {
 }
 
 void VideoEncoder::afterProcessing() {
+    if(mImageWriter) {
+        for(const auto& frame : _mImageFrames)
+            mImageWriter->write(frame.first, frame.second);
+    }
+    _mImageFrames.clear();
     const auto currCanvas = mRenderInstanceSettings->getTargetCanvas();
     if(_mCurrentContainerId != 0) {
         const auto lastEncoded = _mContainers.at(_mCurrentContainerId - 1);
-        currCanvas->setSceneFrame(lastEncoded);
-        currCanvas->setMinFrameUseRange(lastEncoded->getRange().fMax + 1);
+        if(mExtraOutput) {
+            // the lead output handles the scene, extra outputs keep
+            // their own frames alive
+            const int lastFrame = lastEncoded->getRange().fMax;
+            mRenderInstanceSettings->setCurrentRenderFrame(lastFrame);
+        } else {
+            currCanvas->setSceneFrame(lastEncoded);
+            currCanvas->setMinFrameUseRange(lastEncoded->getRange().fMax + 1);
+        }
     }
 
     for(int i = _mContainers.count() - 1; i >= _mCurrentContainerId; i--) {
@@ -847,6 +1005,10 @@ bool VideoEncoder::sStartEncoding(RenderInstanceSettings *settings) {
     return sInstance->startNewEncoding(settings);
 }
 
+bool VideoEncoder::sAddOutput(RenderInstanceSettings *settings) {
+    return sInstance->addOutput(settings);
+}
+
 void VideoEncoder::sAddCacheContainerToEncoder(const stdsptr<SceneFrameContainer> &cont) {
     sInstance->addContainer(cont);
 }
@@ -166,10 +166,13 @@ typedef struct CORE_EXPORT OutputStream {
     AVCodecContext *fCodec = nullptr;
     AVFrame *fDstFrame = nullptr;
     AVFrame *fSrcFrame = nullptr;
-    struct SwsContext *fSwsCtx = nullptr;
+    SkBitmap fUnpremul; // reused for codecs that take straight alpha
+    sk_sp<SkImage> fConverted; // image currently held in fDstFrame
     struct SwrContext *fSwrCtx = nullptr;
 } OutputStream;
 
+class ImageSequenceWriter;
+
 class CORE_EXPORT VideoEncoderEmitter : public QObject {
     Q_OBJECT
 public:
@@ -186,7 +189,7 @@ signals:
 class CORE_EXPORT VideoEncoder : public eHddTask {
     e_OBJECT
 protected:
-    VideoEncoder();
+    VideoEncoder(const bool extraOutput = false);
 public:
     void process();
     void beforeProcessing(const Hardware);
@@ -197,12 +200,14 @@ public:
     }
 
     void interruptCurrentEncoding() {
+        for(const auto& output : mOutputs) output->interruptCurrentEncoding();
         if(isActive()) mInterruptEncoding = true;
         else interrupEncoding();
     }
 
     void finishCurrentEncoding() {
         if(!mCurrentlyEncoding) return;
+        for(const auto& output : mOutputs) output->finishCurrentEncoding();
         if(isActive()) mEncodingFinished = true;
         else finishEncodingSuccess();
     }
@@ -217,12 +222,28 @@ public:
 
     static void sInterruptEncoding();
     static bool sStartEncoding(RenderInstanceSettings *settings);
+    //! @brief Encodes the frames rendered for the current encoding to
+    //! another output as well, see sCanShareRender
+    static bool sAddOutput(RenderInstanceSettings *settings);
+    //! @brief True if output can be encoded from the frames rendered for
+    //! lead: same scene and frames, no higher resolution, matching audio
+    static bool sCanShareRender(const RenderInstanceSettings &lead,
+                                const RenderInstanceSettings &output);
     static void sAddCacheContainerToEncoder(const stdsptr<SceneFrameContainer> &cont);
     static void sAddCacheContainerToEncoder(const stdsptr<Samples> &cont);
     static void sAllAudioProvided();
     static void sFinishEncoding();
     static bool sEncodingSuccessfulyStarted();
     static bool sEncodeAudio();
+    //! @brief Rendering should wait for the encoder to catch up
+    static bool sEncodeQueueFull();
+    //! @brief Converts a rendered image to the codec pixel format and size,
+    //! unpremultiplied for codecs that store straight alpha.
+    static void sConvert(const sk_sp<SkImage> &image,
+                         const AVCodecContext * const codec,
+                         AVFrame * const frame,
+                         SkBitmap &unpremul);
+
 
     VideoEncoderEmitter *getEmitter() {
         return &mEmitter;
@@ -232,12 +253,16 @@ public:
         return mCurrentlyEncoding;
     }
 protected:
+    void queTaskNow();
+
+    int queuedFrames() const;
     void clearContainers();
     VideoEncoderEmitter mEmitter;
     void interrupEncoding();
     void finishEncodingSuccess();
     void finishEncodingNow();
     bool startEncoding(RenderInstanceSettings * const settings);
+    bool addOutput(RenderInstanceSettings * const settings);
     void startEncodingNow();
 
     bool mEncodingSuccesfull = false;
@@ -249,6 +274,9 @@ protected:
     OutputStream mAudioStream;
     AVFormatContext *mFormatContext = nullptr;
     const AVOutputFormat *mOutputFormat = nullptr;
+    stdsptr<ImageSequenceWriter> mImageWriter;
+    const bool mExtraOutput;
+    QList<stdsptr<VideoEncoder>> mOutputs;
     bool mCurrentlyEncoding = false;
     QList<stdsptr<SceneFrameContainer>> mNextContainers;
     QList<stdsptr<Samples>> mNextSoundConts;
@@ -267,6 +295,9 @@ protected:
     FrameRange _mRenderRange;
 
     QList<stdsptr<SceneFrameContainer>> _mContainers;
+    //! @brief Image sequence frames and their repeat count, qued
+    //! to mImageWriter in afterProcessing()
+    QList<QPair<sk_sp<SkImage>, int>> _mImageFrames;
     SoundIterator mSoundIterator;
 };
 
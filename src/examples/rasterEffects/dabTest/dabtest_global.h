@@ -49,5 +49,7 @@ DABTEST_EXPORT void eIdentifier(CustomIdentifier& result);
 
 DABTEST_EXPORT bool eSupports(const CustomIdentifier &identifier);
 
+DABTEST_EXPORT int eApiVersion();
+
 }
 #endif // DABTEST_GLOBAL_H
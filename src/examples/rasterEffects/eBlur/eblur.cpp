@@ -65,6 +65,11 @@ bool eSupports(const CustomIdentifier &identifier) {
     return identifier.fVersion == effectVersion();
 }
 
+// Plugin interface version, 2 - eBlurCaller is a TiledRasterEffectCaller
+int eApiVersion() {
+    return 2;
+}
+
 #include "enveCore/Animators/qrealanimator.h"
 eBlur::eBlur() : CustomRasterEffect(eBName.toLower(),
                                     HardwareSupport::gpuPreffered, false) {
@@ -96,7 +101,7 @@ CustomIdentifier eBlur::getIdentifier() const {
 }
 
 eBlurCaller::eBlurCaller(const HardwareSupport hwSupport, const qreal radius) :
-    RasterEffectCaller(hwSupport, true, radiusToMargin(radius)),
+    TiledRasterEffectCaller(hwSupport, true, radiusToMargin(radius)),
     mRadius(static_cast<float>(radius)) {}
 
 void eBlurCaller::processGpu(QGL33 * const gl,
@@ -119,8 +124,8 @@ void eBlurCaller::processGpu(QGL33 * const gl,
     renderTools.swapTextures();
 }
 
-void eBlurCaller::processCpu(CpuRenderTools &renderTools,
-                             const CpuRenderData &data) {
+void eBlurCaller::processTile(TileRenderTools &tools,
+                              const TileRenderData &data) {
     Q_UNUSED(data)
 
     const float sigma = mRadius*0.3333333f;
@@ -129,20 +134,10 @@ void eBlurCaller::processCpu(CpuRenderTools &renderTools,
     SkPaint paint;
     paint.setImageFilter(filter);
 
-    SkBitmap tile;
-    renderTools.fDstBtmp.extractSubset(&tile, data.fTexTile);
-    SkCanvas canvas(tile);
+    // fSrc already covers the tile plus the radius margin
+    SkCanvas canvas(tools.fDst);
     canvas.clear(SK_ColorTRANSPARENT);
-
-    const int radCeil = static_cast<int>(ceil(mRadius));
-    const auto& srcBtmp = renderTools.fSrcBtmp;
-    const auto& texTile = data.fTexTile;
-    auto srcRect = texTile.makeOutset(radCeil, radCeil);
-    if(srcRect.intersect(srcRect, srcBtmp.bounds())) {
-        SkBitmap tileSrc;
-        srcBtmp.extractSubset(&tileSrc, srcRect);
-        canvas.drawBitmap(tileSrc,
-                          srcRect.left() - texTile.left(),
-                          srcRect.top() - texTile.top(), &paint);
-    }
+    canvas.drawBitmap(tools.fSrc,
+                      -tools.fTileOffset.x(),
+                      -tools.fTileOffset.y(), &paint);
 }
@@ -28,16 +28,17 @@
 
 #include "eblur_global.h"
 #include "enveCore/gpurendertools.h"
+#include "enveCore/RasterEffects/tiledrastereffectcaller.h"
 
-class eBlurCaller : public RasterEffectCaller {
+class eBlurCaller : public TiledRasterEffectCaller {
 public:
     eBlurCaller(const HardwareSupport hwSupport,
                 const qreal radius);
 
     void processGpu(QGL33 * const gl,
                     GpuRenderTools& renderTools);
-    void processCpu(CpuRenderTools& renderTools,
-                    const CpuRenderData &data);
+    void processTile(TileRenderTools& tools,
+                     const TileRenderData& data);
 private:
     const float mRadius;
 };
@@ -49,5 +49,7 @@ EBLUR_EXPORT void eIdentifier(CustomIdentifier& result);
 
 EBLUR_EXPORT bool eSupports(const CustomIdentifier &identifier);
 
+EBLUR_EXPORT int eApiVersion();
+
 }
 #endif // EBLUR_GLOBAL_H
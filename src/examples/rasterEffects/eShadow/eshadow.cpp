@@ -65,6 +65,11 @@ bool eSupports(const CustomIdentifier &identifier) {
     return identifier.fVersion == effectVersion();
 }
 
+// Plugin interface version, 1 - processCpu on the whole source bitmap
+int eApiVersion() {
+    return 1;
+}
+
 #include "enveCore/Animators/qrealanimator.h"
 eShadow::eShadow() :
     CustomRasterEffect(eSName.toLower(), HardwareSupport::gpuPreffered, false) {
@@ -49,5 +49,7 @@ ESHADOW_EXPORT void eIdentifier(CustomIdentifier& result);
 
 ESHADOW_EXPORT bool eSupports(const CustomIdentifier &identifier);
 
+ESHADOW_EXPORT int eApiVersion();
+
 }
 #endif // ESHADOW_GLOBAL_H
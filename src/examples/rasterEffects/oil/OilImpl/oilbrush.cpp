@@ -26,18 +26,18 @@ OilBrush::OilBrush(const SkPoint& _position, float _size,
     bristlesLength = qMin(size, MAX_BRISTLE_LENGTH);
     bristlesThickness = qMin(_bristlesThickness * bristlesLength, MAX_BRISTLE_THICKNESS);
     bristlesHorizontalNoise = qMin(0.3f * size, MAX_BRISTLE_HORIZONTAL_NOISE);
-    bristlesHorizontalNoiseSeed = gSkRandF(0, 1000);
+    bristlesHorizontalNoiseSeed = randF(0, 1000);
 
 	// Initialize the bristles offsets and positions containers with default values
-    unsigned int nBristles = floor(size * gSkRandF(_bristlesDensity*1.6,
+    unsigned int nBristles = floor(size * randF(_bristlesDensity*1.6,
                                                    _bristlesDensity*1.9));
     bOffsets = vector<SkPoint>(nBristles);
     bPositions = vector<SkPoint>(nBristles);
 
 	// Randomize the bristle offset positions
 	for (SkPoint& offset : bOffsets) {
-        offset.set(size * gSkRandF(-0.5, 0.5),
-                   BRISTLE_VERTICAL_NOISE * gSkRandF(-0.5, 0.5));
+        offset.set(size * randF(-0.5, 0.5),
+                   BRISTLE_VERTICAL_NOISE * randF(-0.5, 0.5));
 	}
 
 	// Initialize the variables used to calculate the brush average position
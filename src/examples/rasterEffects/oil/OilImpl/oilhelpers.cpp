@@ -1,5 +1,7 @@
 #include "oilhelpers.h"
 
+#include <QRandomGenerator>
+
 #define OFNOISE_FASTFLOOR(x) ( ((x)>0) ? ((int)x) : (((int)x)-1) )
 
 unsigned char perm[512] = {151,160,137,91,90,15,
@@ -63,3 +65,14 @@ inline float _slang_library_noise1 (float x) {
 float OilHelpers::ofNoise(float x) {
     return _slang_library_noise1(x)*0.5f + 0.5f;
 }
+
+static thread_local QRandomGenerator tRandom;
+
+void OilHelpers::seed(unsigned int value) {
+    tRandom.seed(value);
+}
+
+float OilHelpers::randF(float fMin, float fMax) {
+    const float f = static_cast<float>(tRandom.generateDouble());
+    return fMin + f * (fMax - fMin);
+}
@@ -3,6 +3,17 @@
 
 namespace OilHelpers {
     float ofNoise(float x);
+
+    /**
+     * @brief Seeds the random generator of the calling thread, simulations
+     * seeded with the same value produce the same strokes
+     */
+    void seed(unsigned int value);
+
+    /**
+     * @brief Random value in [fMin, fMax] from the calling thread's generator
+     */
+    float randF(float fMin = 0, float fMax = 1);
 }
 
 #endif // OILHELPERS_H
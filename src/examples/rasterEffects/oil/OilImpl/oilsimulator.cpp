@@ -1,5 +1,6 @@
 #include "oilsimulator.h"
 #include "oiltrace.h"
+#include "oilhelpers.h"
 
 #include "skia/skiahelpers.h"
 #include "simplemath.h"
@@ -102,6 +103,7 @@ void OilSimulator::setImage(const SkBitmap& imagePixels, bool clearCanvas) {
 	obtainNewTrace = true;
 	traceStep = 0;
 	nTraces = 0;
+	mRecordedTraces.clear();
 }
 
 void OilSimulator::update(bool stepByStep) {
@@ -167,7 +169,12 @@ void OilSimulator::updatePixelArrays() {
     const int bgGreen = SkColorGetG(BACKGROUND_COLOR);
     const int bgBlue = SkColorGetB(BACKGROUND_COLOR);
 
-    for (unsigned int pixel = 0, nPixels = mImg.width() * mImg.height(); pixel < nPixels; ++pixel) {
+    const unsigned int width = mImg.width();
+    const SkIRect paintRect = mPaintRect.isEmpty() ? mImg.bounds() : mPaintRect;
+
+    for (int y = paintRect.top(); y < paintRect.bottom(); ++y) {
+    for (int x = paintRect.left(); x < paintRect.right(); ++x) {
+		unsigned int pixel = y * width + x;
 		unsigned int imgPix = pixel * imgNumChannels;
 		unsigned int canvasPix = pixel * canvasNumChannels;
 
@@ -182,6 +189,7 @@ void OilSimulator::updatePixelArrays() {
 			++nBadPaintedPixels;
 		}
 	}
+	}
 }
 
 void OilSimulator::updateVisitedPixels() {
@@ -255,12 +263,12 @@ void OilSimulator::getNewTrace() {
 
 			// Create new traces until one of them has a valid trajectory or we exceed a number of tries
 			bool isValidTrajectory = false;
-            float brushSize = qMax(SMALLER_BRUSH_SIZE, averageBrushSize * gSkRandF(0.95, 1.05));
-            int nSteps = qMax(MIN_TRACE_LENGTH, RELATIVE_TRACE_LENGTH * brushSize * gSkRandF(0.9, 1.1)) / TRACE_SPEED;
+            float brushSize = qMax(SMALLER_BRUSH_SIZE, averageBrushSize * OilHelpers::randF(0.95, 1.05));
+            int nSteps = qMax(MIN_TRACE_LENGTH, RELATIVE_TRACE_LENGTH * brushSize * OilHelpers::randF(0.9, 1.1)) / TRACE_SPEED;
 
 			while (!isValidTrajectory && invalidTrajectoriesCounter % 500 != 499) {
 				// Create the trace starting from a bad painted pixel
-                unsigned int pixel = badPaintedPixels[floor(gSkRandF(0, nBadPaintedPixels))];
+                unsigned int pixel = badPaintedPixels[floor(OilHelpers::randF(0, nBadPaintedPixels))];
                 SkPoint startingPosition = SkPoint::Make(pixel % imgWidth, pixel / imgWidth);
                 trace = OilTrace(startingPosition, nSteps, TRACE_SPEED);
 
@@ -541,6 +549,9 @@ void OilSimulator::paintTrace() {
     } else {
         trace.paint(*mCanvas);
     }
+
+	// Keep the painted trace for later replay
+    if(mRecordTraces) mRecordedTraces.push_back(trace);
 }
 
 void OilSimulator::paintTraceStep() {
@@ -558,3 +569,16 @@ void OilSimulator::paintTraceStep() {
 bool OilSimulator::isFinished() const {
 	return paintingIsFinised;
 }
+
+void OilSimulator::setPaintRect(const SkIRect& rect) {
+    mPaintRect = rect;
+}
+
+void OilSimulator::setRecordTraces(bool record) {
+    mRecordTraces = record;
+    if(!record) mRecordedTraces.clear();
+}
+
+vector<OilTrace>& OilSimulator::getRecordedTraces() {
+    return mRecordedTraces;
+}
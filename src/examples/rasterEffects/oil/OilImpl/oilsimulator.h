@@ -164,6 +164,22 @@ public:
 	 * @return true if the painting is finished
 	 */
     bool isFinished() const;
+
+    /**
+     * @brief Restricts the trace starting positions to the given rect,
+     * traces can still extend outside of it. Empty rect uses the whole image.
+     */
+    void setPaintRect(const SkIRect& rect);
+
+    /**
+     * @brief Sets if the painted traces should be kept for later replay
+     */
+    void setRecordTraces(bool record);
+
+    /**
+     * @brief The traces painted so far, in painting order
+     */
+    vector<OilTrace>& getRecordedTraces();
 protected:
 
     /**
@@ -298,6 +314,21 @@ protected:
 	 */
 	unsigned int traceStep;
 
+	/**
+	 * @brief The rect where traces can start, empty for the whole image
+	 */
+	SkIRect mPaintRect = SkIRect::MakeEmpty();
+
+	/**
+	 * @brief Sets if the painted traces are kept in mRecordedTraces
+	 */
+	bool mRecordTraces = false;
+
+	/**
+	 * @brief The painted traces, if mRecordTraces is set
+	 */
+	vector<OilTrace> mRecordedTraces;
+
 	/**
 	 * @brief The total number of painted traces
 	 */
@@ -25,8 +25,8 @@ OilTrace::OilTrace(const SkPoint& startingPosition, unsigned int nSteps, float s
 	}
 
 	// Fill the positions and alphas containers
-    float initAng = gSkRandF(0, 2*PI);
-    float noiseSeed = gSkRandF(0, 1000);
+    float initAng = randF(0, 2*PI);
+    float noiseSeed = randF(0, 1000);
     float alphaDecrement = qMin(255.0 / nSteps, 25.0);
 
     positions.reserve(nSteps + 1);
@@ -216,7 +216,7 @@ void OilTrace::calculateBristleColors(const SkBitmap& paintedPixels,
 
 	// Calculate the starting colors for each bristle
     vector<SkColor> startingColors = vector<SkColor>(nBristles);
-    float noiseSeed = gSkRandF(0, 1000);
+    float noiseSeed = randF(0, 1000);
     vector<float> averageHSV = {0.f, 0.f, 0.f};
     SkColorToHSV(averageColor, averageHSV.data());
     float& averageBrightness = averageHSV[2];
@@ -321,6 +321,20 @@ void OilTrace::paint(SkCanvas& canvas, SkCanvas& canvasBuffer) {
 	brush.resetPosition(positions[0]);
 }
 
+void OilTrace::replay(SkCanvas& canvas) const {
+	// Check that the bristle colors have been calculated before running this method
+	if (bColors.size() == 0) {
+        RuntimeThrow("Please, run calculateBristleColors method before replay.");
+	}
+
+	// Move a copy of the brush, the trace stays untouched
+	OilBrush replayBrush = brush;
+	for (unsigned int i = 0, nSteps = getNSteps(); i < nSteps; ++i) {
+		replayBrush.updatePosition(positions[i], true);
+        replayBrush.paint(canvas, bColors[i], alphas[i]);
+	}
+}
+
 void OilTrace::paintStep(SkCanvas& canvas, unsigned int step) {
 	// Check that the bristle colors have been calculated before running this method
 	if (bColors.size() == 0) {
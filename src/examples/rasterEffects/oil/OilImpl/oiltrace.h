@@ -103,6 +103,14 @@ public:
 	 */
     void paint(SkCanvas& canvas, SkCanvas& canvasBuffer);
 
+    /**
+     * @brief Paints an already simulated trace without modifying it,
+     * can be called from several threads at once
+     *
+     * @param canvas the canvas where the trace should be painted
+     */
+    void replay(SkCanvas& canvas) const;
+
 	/**
 	 * @brief Paints a given step in the trace trajectory
 	 *
@@ -5,6 +5,10 @@
 #include "ReadWrite/evformat.h"
 
 #include "appsupport.h"
+#include "RasterEffects/tiledrastereffectcaller.h"
+#include "OilImpl/oilhelpers.h"
+
+#include <QMutex>
 
 #define TIME_BEGIN const auto t1 = std::chrono::high_resolution_clock::now();
 #define TIME_END(name) const auto t2 = std::chrono::high_resolution_clock::now(); \
@@ -65,7 +69,71 @@ QMargins OilEffect::getMargin() const {
                            mBrushSize->getEffectiveYValue());
 }
 
-class OilEffectCaller : public RasterEffectCaller {
+struct OilStroke {
+    OilTrace fTrace;
+
+    //! @brief Stroke bounds in texture coordinates
+    SkRect fBounds;
+};
+
+typedef vector<OilStroke> OilStrokes;
+
+struct OilRegion {
+    //! @brief Tile where the region strokes start
+    SkIRect fTile;
+
+    //! @brief Texture position of the simulated region image
+    SkIPoint fOrigin;
+
+    stdsptr<const OilStrokes> fStrokes;
+};
+
+struct OilRegionKey {
+    QVector<qreal> fParams;
+    SkIRect fSrcRect;
+    SkIRect fTile;
+    uint fHash;
+
+    bool operator==(const OilRegionKey& other) const {
+        return fHash == other.fHash &&
+               fSrcRect == other.fSrcRect &&
+               fTile == other.fTile &&
+               fParams == other.fParams;
+    }
+};
+
+// regions per texture and cached stroke sets
+static const int sMaxRegions = 64;
+
+//! @brief Strokes of recently simulated regions, reused across frames
+//! as long as the parameters and the region pixels do not change
+class OilStrokeCache {
+public:
+    static stdsptr<const OilStrokes> sGet(const OilRegionKey& key) {
+        QMutexLocker locker(&sMutex);
+        for(int i = 0; i < sRegions.count(); i++) {
+            if(!(sRegions.at(i).first == key)) continue;
+            sRegions.move(i, 0);
+            return sRegions.first().second;
+        }
+        return nullptr;
+    }
+
+    static void sAdd(const OilRegionKey& key,
+                     const stdsptr<const OilStrokes>& strokes) {
+        QMutexLocker locker(&sMutex);
+        sRegions.prepend({key, strokes});
+        while(sRegions.count() > sMaxRegions) sRegions.removeLast();
+    }
+private:
+    static QMutex sMutex;
+    static QList<QPair<OilRegionKey, stdsptr<const OilStrokes>>> sRegions;
+};
+
+QMutex OilStrokeCache::sMutex;
+QList<QPair<OilRegionKey, stdsptr<const OilStrokes>>> OilStrokeCache::sRegions;
+
+class OilEffectCaller : public TiledRasterEffectCaller {
 public:
     OilEffectCaller(const QPointF& brushSize,
                     const qreal accuracy,
@@ -76,7 +144,7 @@ public:
                     const qreal bristleDensity,
                     const QMargins& margin,
                     const HardwareSupport hwSupport) :
-        RasterEffectCaller(hwSupport, false, margin),
+        TiledRasterEffectCaller(hwSupport, false, margin),
         mMinBrushSize(brushSize.x()),
         mMaxBrushSize(brushSize.y()),
         mAccuracy(accuracy),
@@ -86,11 +154,6 @@ public:
         mBristleThickness(bristleThickness),
         mBristleDensity(bristleDensity) {}
 
-    int cpuThreads(const int available, const int area) const {
-        Q_UNUSED(available) Q_UNUSED(area)
-        return 1;
-    }
-
     void setupSimulator(OilSimulator& simulator) {
         simulator.SMALLER_BRUSH_SIZE = mMinBrushSize;
         simulator.BIGGER_BRUSH_SIZE = mMaxBrushSize;
@@ -102,30 +165,43 @@ public:
         simulator.BRISTLE_DENSITY = mBristleDensity;
     }
 
-    void processCpu(CpuRenderTools& renderTools,
-                    const CpuRenderData &data) {
-        Q_UNUSED(data);
-        if(mMaxStrokes <= 0) return;
+    // regions are split from the texture size only, not the core count,
+    // so every machine simulates the same strokes, and never more regions
+    // than the stroke cache holds
+    int cpuThreads(const int available, const int area) const {
+        Q_UNUSED(available)
+        return qMin(area/(256*256) + 1, sMaxRegions);
+    }
+
+    // pass 0 simulates the strokes starting in each tile (in parallel),
+    // pass 1 paints the strokes of all the regions overlapping each tile
+    int passCount() const { return 2; }
+
+    QMargins tileMargin(const int pass) const {
+        return pass == 0 ? fMargin : QMargins();
+    }
+
+    size_t scratchBytes(const TileRenderData& data) const {
+        if(data.fPass != 0) return 0;
+        // packed copy of the region image and the simulator canvas
+        return 2*4*static_cast<size_t>(data.fSrcRect.width())*
+               static_cast<size_t>(data.fSrcRect.height());
+    }
+
+    void processTile(TileRenderTools& tools,
+                     const TileRenderData& data) {
 #ifdef OilEffect_TIMING
         TIME_BEGIN
 #endif
-        OilSimulator simulator(renderTools.fDstBtmp, false, false);
-        setupSimulator(simulator);
-
-        simulator.setImage(renderTools.fSrcBtmp, true);
-
-        for(int i = 0; i < mMaxStrokes; i++) {
-            simulator.update(false);
-            if(simulator.isFinished()) break;
-        }
+        if(data.fPass == 0) simulateRegion(tools, data);
+        else paintRegions(tools, data);
 #ifdef OilEffect_TIMING
-        TIME_END("CPU Oil Painting")
+        TIME_END("CPU Oil Painting Tile")
 #endif
     }
 
     void processGpu(QGL33 * const gl, GpuRenderTools &renderTools) {
         Q_UNUSED(gl)
-        if(mMaxStrokes <= 0) return;
 #ifdef OilEffect_TIMING
         TIME_BEGIN
 #endif
@@ -153,6 +229,7 @@ public:
 
         simulator.setImage(srcBtmp, true);
 
+        OilHelpers::seed(0);
         for(int i = 0; i < mMaxStrokes; i++) {
             simulator.update(false);
             if(simulator.isFinished()) break;
@@ -165,6 +242,121 @@ public:
 #endif
     }
 private:
+    OilRegionKey regionKey(const SkBitmap& img,
+                           const TileRenderData& data) const {
+        const size_t bytes = img.rowBytes()*static_cast<size_t>(img.height());
+        return {{mMinBrushSize, mMaxBrushSize, mAccuracy, mStrokeLength,
+                 mResolution, qreal(mMaxStrokes), mBristleThickness,
+                 mBristleDensity, qreal(data.fWidth), qreal(data.fHeight)},
+                data.fSrcRect, data.fTile, qHashBits(img.getPixels(), bytes)};
+    }
+
+    void simulateRegion(TileRenderTools& tools,
+                        const TileRenderData& data) {
+        const auto& srcRect = data.fSrcRect;
+        const int width = srcRect.width();
+        const int height = srcRect.height();
+        const auto info = SkiaHelpers::getPremulRGBAInfo(width, height);
+        const size_t rowBytes = info.minRowBytes();
+        const auto scratch = tools.fScratch.as<uchar>();
+
+        // the simulator expects tightly packed rows
+        SkBitmap img;
+        img.installPixels(info, scratch, rowBytes);
+        tools.fSrc.readPixels(img.pixmap());
+
+        const auto key = regionKey(img, data);
+        auto strokes = OilStrokeCache::sGet(key);
+        if(!strokes) {
+            SkBitmap canvasBtmp;
+            canvasBtmp.installPixels(info, scratch + rowBytes*height, rowBytes);
+            strokes = simulate(img, canvasBtmp, data);
+            OilStrokeCache::sAdd(key, strokes);
+        }
+
+        QMutexLocker locker(&mRegionsMutex);
+        mRegions.push_back({data.fTile,
+                            SkIPoint::Make(srcRect.left(), srcRect.top()),
+                            strokes});
+    }
+
+    stdsptr<const OilStrokes> simulate(const SkBitmap& img,
+                                       SkBitmap& dst,
+                                       const TileRenderData& data) {
+        const auto& tile = data.fTile;
+        const auto& srcRect = data.fSrcRect;
+
+        // same strokes for the same region, regardless of thread scheduling
+        OilHelpers::seed(static_cast<uint>(tile.left())*73856093u ^
+                         static_cast<uint>(tile.top())*19349663u);
+
+        OilSimulator simulator(dst, false, false);
+        setupSimulator(simulator);
+        simulator.setImage(img, true);
+        simulator.setPaintRect(tile.makeOffset(-srcRect.left(),
+                                               -srcRect.top()));
+        simulator.setRecordTraces(true);
+
+        // stroke budget is shared between the regions by area
+        const qreal area = qreal(tile.width())*tile.height();
+        const qreal totalArea = qreal(data.fWidth)*data.fHeight;
+        const int maxStrokes = qCeil(mMaxStrokes*area/totalArea);
+        for(int i = 0; i < maxStrokes; i++) {
+            simulator.update(false);
+            if(simulator.isFinished()) break;
+        }
+
+        const auto result = std::make_shared<OilStrokes>();
+        const float outset = static_cast<float>(mMaxBrushSize);
+        for(auto& trace : simulator.getRecordedTraces()) {
+            const auto& positions = trace.getTrajectoryPositions();
+            SkRect bounds;
+            bounds.setBounds(positions.data(),
+                             static_cast<int>(positions.size()));
+            bounds.outset(outset, outset);
+            bounds.offset(srcRect.left(), srcRect.top());
+            result->push_back({std::move(trace), bounds});
+        }
+        return result;
+    }
+
+    const std::vector<OilRegion>& sortedRegions() {
+        // all the regions are simulated before pass 1 starts
+        QMutexLocker locker(&mRegionsMutex);
+        if(!mRegionsSorted) {
+            std::sort(mRegions.begin(), mRegions.end(),
+                      [](const OilRegion& a, const OilRegion& b) {
+                if(a.fTile.top() != b.fTile.top()) {
+                    return a.fTile.top() < b.fTile.top();
+                }
+                return a.fTile.left() < b.fTile.left();
+            });
+            mRegionsSorted = true;
+        }
+        return mRegions;
+    }
+
+    void paintRegions(TileRenderTools& tools,
+                      const TileRenderData& data) {
+        const auto& tile = data.fTile;
+        const auto tileRect = SkRect::Make(tile);
+
+        SkCanvas canvas(tools.fDst);
+        canvas.clear(OilSimulator::BACKGROUND_COLOR);
+
+        // regions are painted in a fixed order for deterministic overlaps
+        for(const auto& region : sortedRegions()) {
+            canvas.save();
+            canvas.translate(region.fOrigin.x() - tile.left(),
+                             region.fOrigin.y() - tile.top());
+            for(const auto& stroke : *region.fStrokes) {
+                if(!SkRect::Intersects(stroke.fBounds, tileRect)) continue;
+                stroke.fTrace.replay(canvas);
+            }
+            canvas.restore();
+        }
+    }
+
     const qreal mMinBrushSize;
     const qreal mMaxBrushSize;
     const qreal mAccuracy;
@@ -173,6 +365,10 @@ private:
     const int mMaxStrokes;
     const qreal mBristleThickness;
     const qreal mBristleDensity;
+
+    QMutex mRegionsMutex;
+    bool mRegionsSorted = false;
+    std::vector<OilRegion> mRegions;
 };
 
 stdsptr<RasterEffectCaller> OilEffect::getEffectCaller(
@@ -184,6 +380,7 @@ stdsptr<RasterEffectCaller> OilEffect::getEffectCaller(
     const qreal acc = mAccuracy->getEffectiveValue(relFrame);
     const qreal len = mStrokeLength->getEffectiveValue(relFrame);
     const int maxStrokes = qRound(mMaxStrokes->getEffectiveValue(relFrame));
+    if(maxStrokes <= 0) return nullptr;
     const qreal thick = mBristleThickness->getEffectiveValue(relFrame)*resolution;
     const qreal den = mBristleDensity->getEffectiveValue(relFrame)/resolution;
     const QMargins margin = oilEffectMargin(len, size.y());
@@ -98,6 +98,21 @@ PerformanceSettingsWidget::PerformanceSettingsWidget(QWidget *parent)
     ramCapSett->addWidget(mRamMBCapSpin);
     capLayout->addLayout(ramCapSett);
 
+    QHBoxLayout* readAheadSett = new QHBoxLayout;
+
+    const auto readAheadLabel = new QLabel(tr("Image sequence read-ahead"),
+                                           this);
+    mImageSequenceReadAheadSpin = new QSpinBox(this);
+    mImageSequenceReadAheadSpin->setRange(0, 64);
+    mImageSequenceReadAheadSpin->setSuffix(tr(" frames"));
+    mImageSequenceReadAheadSpin->setToolTip(
+                tr("Frames loaded ahead of playback in image sequences."));
+
+    readAheadSett->addWidget(readAheadLabel);
+    readAheadSett->addStretch();
+    readAheadSett->addWidget(mImageSequenceReadAheadSpin);
+    capLayout->addLayout(readAheadSett);
+
     const auto gpuGroup = new QGroupBox(HardwareInfo::sGpuRendererString(),
                                         this);
     gpuGroup->setObjectName("BlueBox");
@@ -178,6 +193,7 @@ void PerformanceSettingsWidget::applySettings()
                 mCpuThreadsCapSlider->value() : 0;
     mSett.fRamMBCap = intMB(mRamMBCapCheck->isChecked() ?
                 mRamMBCapSpin->value() : 0);
+    mSett.fImageSequenceReadAhead = mImageSequenceReadAheadSpin->value();
     mSett.fAccPreference = static_cast<AccPreference>(
                 mAccPreferenceSlider->value());
     mSett.fPathGpuAcc = mPathGpuAccCheck->isChecked();
@@ -205,6 +221,8 @@ void PerformanceSettingsWidget::updateSettings(bool restore)
                                 intMB(HardwareInfo::sRamKB()).fValue;
     mRamMBCapSpin->setValue(nRamMB);
 
+    mImageSequenceReadAheadSpin->setValue(mSett.fImageSequenceReadAhead);
+
     mAccPreferenceSlider->setValue(static_cast<int>(mSett.fAccPreference));
     updateAccPreferenceDesc();
     mPathGpuAccCheck->setChecked(mSett.fPathGpuAcc);
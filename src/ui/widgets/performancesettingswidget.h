@@ -59,6 +59,8 @@ private:
     QSpinBox* mRamMBCapSpin = nullptr;
     QSlider* mRamMBCapSlider = nullptr;
 
+    QSpinBox* mImageSequenceReadAheadSpin = nullptr;
+
     QLabel* mAccPreferenceLabel = nullptr;
     QLabel* mAccPreferenceDescLabel = nullptr;
     QLabel* mAccPreferenceCpuLabel = nullptr;
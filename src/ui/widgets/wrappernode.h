@@ -74,6 +74,10 @@ public:
 
     static WrapperNode *sRead(eReadStream& src,
                               const WidgetCreator& creator);
+    typedef std::function<void(eReadStream&)> WidgetSkipper;
+    //! @brief Skips a node written by write() without creating widgets,
+    //! skipWidget skips the data of a single widget node
+    static void sSkip(eReadStream& src, const WidgetSkipper& skipWidget);
     static WrapperNode *sReadXEV(XevReadBoxesHandler& boxReadHandler,
                                  const QDomElement& ele,
                                  const WidgetCreator& creator,